@@ -11,3 +11,53 @@ src_bin_echart_CPPFLAGS = \
 src_bin_echart_LDADD = \
 src/lib/libechart.la \
 @ECHART_BIN_LIBS@
+
+noinst_PROGRAMS = \
+src/bin/echart_bench_points \
+src/bin/echart_bench_polyline \
+src/bin/echart_bench_render \
+src/bin/echart_stress_shared
+
+src_bin_echart_bench_points_SOURCES = \
+src/bin/echart_bench_points.c
+
+src_bin_echart_bench_points_CPPFLAGS = \
+-I$(top_srcdir)/src/lib \
+@ECHART_BIN_CFLAGS@
+
+src_bin_echart_bench_points_LDADD = \
+src/lib/libechart.la \
+@ECHART_BIN_LIBS@
+
+src_bin_echart_bench_polyline_SOURCES = \
+src/bin/echart_bench_polyline.c
+
+src_bin_echart_bench_polyline_CPPFLAGS = \
+-I$(top_srcdir)/src/lib \
+@ECHART_BIN_CFLAGS@
+
+src_bin_echart_bench_polyline_LDADD = \
+src/lib/libechart.la \
+@ECHART_BIN_LIBS@
+
+src_bin_echart_bench_render_SOURCES = \
+src/bin/echart_bench_render.c
+
+src_bin_echart_bench_render_CPPFLAGS = \
+-I$(top_srcdir)/src/lib \
+@ECHART_BIN_CFLAGS@
+
+src_bin_echart_bench_render_LDADD = \
+src/lib/libechart.la \
+@ECHART_BIN_LIBS@
+
+src_bin_echart_stress_shared_SOURCES = \
+src/bin/echart_stress_shared.c
+
+src_bin_echart_stress_shared_CPPFLAGS = \
+-I$(top_srcdir)/src/lib \
+@ECHART_BIN_CFLAGS@
+
+src_bin_echart_stress_shared_LDADD = \
+src/lib/libechart.la \
+@ECHART_BIN_LIBS@
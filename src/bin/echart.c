@@ -45,7 +45,6 @@ int main()
     size_t stride;
     Enesim_Surface *s;
     Enesim_Renderer *rline;
-    Enesim_Log *error = NULL;
     Echart_Line *line;
     Echart_Column *column;
     Echart_Chart *chart;
@@ -125,12 +124,8 @@ int main()
     evas_object_show(o);
 
     s = enesim_surface_new_data_from(ENESIM_FORMAT_ARGB8888, w, h, EINA_FALSE, m, stride, NULL, NULL);
-    if (!enesim_renderer_draw(rline, s, ENESIM_ROP_FILL, NULL, 0, 0,
-                              &error))
-    {
+    if (!echart_render(rline, s, 0))
         printf("merde\n");
-        enesim_log_dump(error);
-    }
 
     ecore_evas_resize(ee, w, h);
     ecore_evas_show(ee);
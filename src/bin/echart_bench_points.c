@@ -0,0 +1,163 @@
+/* Echart - Chart rendering library
+ * Copyright (C) 2013 Vincent Torri
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Times the construction of the scene of a line chart with two series, plain
+ * and stacked, from 1k to 10M points. Once the fixed cost of the scene is
+ * amortized, the time per point must not grow with the number of points.
+ */
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <math.h>
+
+#include <Ecore.h>
+
+#include <Enesim.h>
+
+#include <Echart.h>
+
+#define SIZES_NBR 5
+#define RUNS_NBR 3
+
+/*
+ * The data is created for each run, as the stacked view and the intervals
+ * of the items are cached in it.
+ */
+static double
+_echart_bench_points_run(const double *values, unsigned int count, Eina_Bool stacked)
+{
+    Echart_Chart *chart;
+    Echart_Data *data;
+    Echart_Data_Item *absciss;
+    Echart_Data_Item *items[2];
+    Echart_Line *line;
+    double t;
+
+    data = echart_data_new();
+
+    absciss = echart_data_item_new();
+    echart_data_item_values_add(absciss, values, count);
+    echart_data_absciss_set(data, absciss);
+
+    items[0] = echart_data_item_new();
+    echart_data_item_values_add(items[0], values + count, count);
+    echart_data_items_set(data, items[0]);
+
+    items[1] = echart_data_item_new();
+    echart_data_item_values_add(items[1], values + 2 * count, count);
+    echart_data_items_set(data, items[1]);
+
+    chart = echart_chart_new();
+    echart_chart_data_set(chart, data);
+
+    line = echart_line_new();
+    echart_line_chart_set(line, chart);
+    echart_line_area_set(line, EINA_TRUE);
+    echart_line_stacked_set(line, stacked);
+
+    t = ecore_time_get();
+    echart_line_update(line);
+    t = ecore_time_get() - t;
+
+    echart_line_chart_free(line);
+    echart_chart_free(chart);
+    echart_data_item_free(items[1]);
+    echart_data_item_free(items[0]);
+    echart_data_item_free(absciss);
+
+    return t;
+}
+
+static double
+_echart_bench_points_best_get(const double *values, unsigned int count, Eina_Bool stacked)
+{
+    double best;
+    double t;
+    unsigned int run;
+
+    best = -1;
+    for (run = 0; run < RUNS_NBR; run++)
+    {
+        t = _echart_bench_points_run(values, count, stacked);
+        if ((best < 0) || (t < best))
+            best = t;
+    }
+
+    return best;
+}
+
+int main()
+{
+    unsigned int sizes[SIZES_NBR] = { 1000, 10000, 100000, 1000000, 10000000 };
+    unsigned int i;
+
+    if (!ecore_init())
+        return -1;
+
+    if (!echart_init())
+    {
+        ecore_shutdown();
+        return -1;
+    }
+
+    printf("%10s %14s %10s %14s %10s\n",
+           "points", "line (ms)", "ns/point", "stacked (ms)", "ns/point");
+    for (i = 0; i < SIZES_NBR; i++)
+    {
+        double *values;
+        double t_line;
+        double t_stacked;
+        unsigned int count;
+        unsigned int j;
+
+        /* the absciss, then the values of the two series */
+        count = sizes[i];
+        values = (double *)malloc(3 * (size_t)count * sizeof(double));
+        if (!values)
+        {
+            fprintf(stderr, "Not enough memory for %u points\n", count);
+            break;
+        }
+
+        for (j = 0; j < count; j++)
+        {
+            values[j] = j;
+            values[count + j] = 1000 + 500 * sin(j * 0.001);
+            values[2 * count + j] = 500 + 250 * cos(j * 0.003);
+        }
+
+        t_line = _echart_bench_points_best_get(values, count, EINA_FALSE);
+        t_stacked = _echart_bench_points_best_get(values, count, EINA_TRUE);
+        free(values);
+
+        printf("%10u %14.3f %10.2f %14.3f %10.2f\n",
+               count,
+               t_line * 1e3, t_line * 1e9 / count,
+               t_stacked * 1e3, t_stacked * 1e9 / count);
+    }
+
+    echart_shutdown();
+    ecore_shutdown();
+
+    return 0;
+}
@@ -0,0 +1,217 @@
+/* Echart - Chart rendering library
+ * Copyright (C) 2013 Vincent Torri
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Compares the lines of the series of a 1920x1080 line chart with a stroked
+ * Enesim path of the same points. The time of the chart is the one of a
+ * full update of the scene and of its drawing, so it also includes the
+ * background, the grid and the labels: the speedup printed is a lower
+ * bound of the one of the lines alone. The series is not decimated, so
+ * that both draw all the points.
+ */
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <math.h>
+
+#include <Ecore.h>
+
+#include <Enesim.h>
+
+#include <Echart.h>
+
+#define WIDTH 1920
+#define HEIGHT 1080
+#define SIZES_NBR 4
+#define WEIGHTS_NBR 2
+#define RUNS_NBR 5
+
+static double
+_echart_bench_polyline_path(Enesim_Surface *surface, const double *x, const double *y,
+                            unsigned int count, double weight)
+{
+    Enesim_Renderer *r;
+    Enesim_Path *p;
+    double best;
+    unsigned int run;
+    unsigned int i;
+
+    r = enesim_renderer_path_new();
+    enesim_renderer_shape_stroke_weight_set(r, weight);
+    enesim_renderer_shape_stroke_color_set(r, 0xff0000ff);
+    enesim_renderer_shape_draw_mode_set(r, ENESIM_RENDERER_SHAPE_DRAW_MODE_STROKE);
+
+    best = -1;
+    for (run = 0; run < RUNS_NBR; run++)
+    {
+        double t;
+
+        t = ecore_time_get();
+        p = enesim_path_new();
+        enesim_path_move_to(p, x[0], y[0]);
+        for (i = 1; i < count; i++)
+            enesim_path_line_to(p, x[i], y[i]);
+        enesim_renderer_path_path_set(r, p);
+        enesim_renderer_draw(r, surface, ENESIM_ROP_BLEND, NULL, 0, 0, NULL);
+        t = ecore_time_get() - t;
+        if ((best < 0) || (t < best))
+            best = t;
+    }
+
+    enesim_renderer_unref(r);
+
+    return best;
+}
+
+static double
+_echart_bench_polyline_chart(Enesim_Surface *surface, const double *x, const double *y,
+                             unsigned int count, double weight)
+{
+    Echart_Chart *chart;
+    Echart_Data *data;
+    Echart_Data_Item *absciss;
+    Echart_Data_Item *items[2];
+    Echart_Line *line;
+    double best;
+    unsigned int run;
+
+    data = echart_data_new();
+    absciss = echart_data_item_new();
+    echart_data_item_values_add(absciss, x, count);
+    echart_data_absciss_set(data, absciss);
+    /* the line draws the items after the first one */
+    items[0] = echart_data_item_new();
+    echart_data_item_values_add(items[0], y, count);
+    echart_data_items_set(data, items[0]);
+    items[1] = echart_data_item_new();
+    echart_data_item_values_add(items[1], y, count);
+    echart_data_items_set(data, items[1]);
+
+    chart = echart_chart_new();
+    echart_chart_size_set(chart, WIDTH, HEIGHT);
+    echart_chart_data_set(chart, data);
+
+    line = echart_line_new();
+    echart_line_chart_set(line, chart);
+    echart_line_decimation_set(line, ECHART_DECIMATION_NONE);
+
+    best = -1;
+    for (run = 0; run < RUNS_NBR; run++)
+    {
+        Enesim_Renderer *scene;
+        double t;
+
+        /* a change of the weight rebuilds the whole scene */
+        echart_line_stroke_weight_set(line, (run & 1) ? weight : weight * (1 + 1e-9));
+
+        t = ecore_time_get();
+        scene = echart_line_renderer_get(line);
+        if (scene)
+        {
+            echart_render(scene, surface, 1);
+            enesim_renderer_unref(scene);
+        }
+        t = ecore_time_get() - t;
+        if ((best < 0) || (t < best))
+            best = t;
+    }
+
+    echart_line_chart_free(line);
+    echart_chart_free(chart);
+    echart_data_item_free(items[1]);
+    echart_data_item_free(items[0]);
+    echart_data_item_free(absciss);
+
+    return best;
+}
+
+int main()
+{
+    unsigned int sizes[SIZES_NBR] = { 1000, WIDTH, 4 * WIDTH, 100000 };
+    double weights[WEIGHTS_NBR] = { 1, 4 };
+    Enesim_Surface *surface;
+    unsigned int i;
+    unsigned int k;
+
+    if (!ecore_init())
+        return -1;
+
+    if (!echart_init())
+    {
+        ecore_shutdown();
+        return -1;
+    }
+
+    surface = enesim_surface_new(ENESIM_FORMAT_ARGB8888, WIDTH, HEIGHT);
+    if (!surface)
+    {
+        echart_shutdown();
+        ecore_shutdown();
+        return -1;
+    }
+
+    printf("%10s %8s %12s %12s %10s\n",
+           "points", "weight", "path (ms)", "chart (ms)", "speedup");
+    for (i = 0; i < SIZES_NBR; i++)
+    {
+        double *x;
+        double *y;
+        unsigned int count;
+        unsigned int j;
+
+        count = sizes[i];
+        x = (double *)malloc(2 * (size_t)count * sizeof(double));
+        if (!x)
+        {
+            fprintf(stderr, "Not enough memory for %u points\n", count);
+            break;
+        }
+        y = x + count;
+
+        /* a noisy signal over the whole width and height */
+        for (j = 0; j < count; j++)
+        {
+            x[j] = j * (WIDTH - 1.0) / (count - 1);
+            y[j] = HEIGHT / 2.0 + (HEIGHT / 3.0) * sin(j * 0.01) + (HEIGHT / 10.0) * sin(j * 0.37);
+        }
+
+        for (k = 0; k < WEIGHTS_NBR; k++)
+        {
+            double t_path;
+            double t_chart;
+
+            t_path = _echart_bench_polyline_path(surface, x, y, count, weights[k]);
+            t_chart = _echart_bench_polyline_chart(surface, x, y, count, weights[k]);
+            printf("%10u %8.0f %12.3f %12.3f %10.1f\n",
+                   count, weights[k], t_path * 1e3, t_chart * 1e3,
+                   (t_chart > 0) ? t_path / t_chart : 0.0);
+        }
+
+        free(x);
+    }
+
+    enesim_surface_unref(surface);
+    echart_shutdown();
+    ecore_shutdown();
+
+    return 0;
+}
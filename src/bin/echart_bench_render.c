@@ -0,0 +1,157 @@
+/* Echart - Chart rendering library
+ * Copyright (C) 2013 Vincent Torri
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Times echart_render() from 1 thread to one per CPU, or to the number
+ * given on the command line, on the scene of a 1920x1080 line chart with
+ * areas. The scene is built once before, so only the drawing of its
+ * layers in the surface is timed, which is the part done in parallel.
+ */
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <math.h>
+
+#include <Ecore.h>
+
+#include <Enesim.h>
+
+#include <Echart.h>
+
+#define WIDTH 1920
+#define HEIGHT 1080
+#define POINTS_NBR 10000
+#define SERIES_NBR 3
+#define RUNS_NBR 5
+
+static double
+_echart_bench_render_best_get(Enesim_Renderer *scene, Enesim_Surface *surface,
+                              unsigned int n_threads)
+{
+    double best;
+    double t;
+    unsigned int run;
+
+    best = -1;
+    for (run = 0; run < RUNS_NBR; run++)
+    {
+        t = ecore_time_get();
+        echart_render(scene, surface, n_threads);
+        t = ecore_time_get() - t;
+        if ((best < 0) || (t < best))
+            best = t;
+    }
+
+    return best;
+}
+
+int main(int argc, char *argv[])
+{
+    Echart_Data_Item *items[SERIES_NBR + 1];
+    Echart_Data_Item *absciss;
+    Echart_Data *data;
+    Echart_Chart *chart;
+    Echart_Line *line;
+    Enesim_Renderer *scene;
+    Enesim_Surface *surface;
+    double t_one;
+    double t;
+    unsigned int threads_max;
+    unsigned int i;
+    unsigned int j;
+
+    if (!ecore_init())
+        return -1;
+
+    if (!echart_init())
+    {
+        ecore_shutdown();
+        return -1;
+    }
+
+    threads_max = (argc > 1) ? (unsigned int)atoi(argv[1]) : (unsigned int)eina_cpu_count();
+    if (!threads_max)
+        threads_max = 1;
+
+    /* the line draws the items after the first one */
+    data = echart_data_new();
+    absciss = echart_data_item_new();
+    for (i = 0; i < POINTS_NBR; i++)
+        echart_data_item_value_add(absciss, i);
+    echart_data_absciss_set(data, absciss);
+    for (j = 0; j <= SERIES_NBR; j++)
+    {
+        items[j] = echart_data_item_new();
+        for (i = 0; i < POINTS_NBR; i++)
+            echart_data_item_value_add(items[j], 1000 + 400 * sin(i * 0.002 * (j + 1)) + 100 * sin(i * 0.3));
+        echart_data_items_set(data, items[j]);
+    }
+
+    chart = echart_chart_new();
+    echart_chart_size_set(chart, WIDTH, HEIGHT);
+    echart_chart_data_set(chart, data);
+
+    line = echart_line_new();
+    echart_line_chart_set(line, chart);
+    echart_line_area_set(line, EINA_TRUE);
+
+    surface = enesim_surface_new(ENESIM_FORMAT_ARGB8888, WIDTH, HEIGHT);
+    scene = echart_line_renderer_get(line);
+    if (!surface || !scene)
+    {
+        fprintf(stderr, "Could not create the scene\n");
+        if (scene)
+            enesim_renderer_unref(scene);
+        if (surface)
+            enesim_surface_unref(surface);
+        echart_line_chart_free(line);
+        echart_chart_free(chart);
+        for (j = 0; j <= SERIES_NBR; j++)
+            echart_data_item_free(items[j]);
+        echart_data_item_free(absciss);
+        echart_shutdown();
+        ecore_shutdown();
+        return -1;
+    }
+
+    printf("%8s %12s %10s\n", "threads", "render (ms)", "speedup");
+    t_one = _echart_bench_render_best_get(scene, surface, 1);
+    printf("%8u %12.3f %10.2f\n", 1, t_one * 1e3, 1.0);
+    for (i = 2; i <= threads_max; i++)
+    {
+        t = _echart_bench_render_best_get(scene, surface, i);
+        printf("%8u %12.3f %10.2f\n", i, t * 1e3, (t > 0) ? t_one / t : 0.0);
+    }
+
+    enesim_renderer_unref(scene);
+    enesim_surface_unref(surface);
+    echart_line_chart_free(line);
+    echart_chart_free(chart);
+    for (j = 0; j <= SERIES_NBR; j++)
+        echart_data_item_free(items[j]);
+    echart_data_item_free(absciss);
+
+    echart_shutdown();
+    ecore_shutdown();
+
+    return 0;
+}
@@ -0,0 +1,240 @@
+/* Echart - Chart rendering library
+ * Copyright (C) 2013 Vincent Torri
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Stress test of the shared mode: one writer thread appends rows to a shared
+ * data while reader threads take snapshots and check them. The values of a
+ * row are known from its index, so a reader detects torn or stale rows, and
+ * the ranges of the item with a level of detail are checked against the
+ * values. It is meant to be built with ThreadSanitizer, which must not
+ * report anything:
+ *
+ *   ./configure CFLAGS="-g -O1 -fsanitize=thread" LDFLAGS="-fsanitize=thread"
+ *   make src/bin/echart_stress_shared
+ *   ./src/bin/echart_stress_shared [readers] [rows]
+ */
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <stdlib.h>
+#include <stdio.h>
+
+#include <Eina.h>
+
+#include <Enesim.h>
+
+#include <Echart.h>
+
+#define READERS_MAX 64
+
+typedef struct _Stress Stress;
+
+struct _Stress
+{
+    Echart_Data *data;
+    unsigned int rows;
+    int done;
+};
+
+typedef struct _Stress_Reader Stress_Reader;
+
+struct _Stress_Reader
+{
+    Stress *stress;
+    unsigned long snapshots;
+    unsigned long errors;
+};
+
+static void *
+_echart_stress_writer(void *data, Eina_Thread t EINA_UNUSED)
+{
+    Stress *stress;
+    double values[2];
+    unsigned int i;
+
+    stress = (Stress *)data;
+    for (i = 0; i < stress->rows; i++)
+    {
+        values[0] = 2.0 * i;
+        values[1] = -1.0 * i;
+        echart_data_values_push(stress->data, i, values);
+    }
+    __atomic_store_n(&stress->done, 1, __ATOMIC_RELEASE);
+
+    return NULL;
+}
+
+static unsigned long
+_echart_stress_snapshot_check(const Echart_Data *snapshot, unsigned int *last)
+{
+    const Echart_Data_Item *x;
+    const Echart_Data_Item *a;
+    const Echart_Data_Item *b;
+    unsigned long errors;
+    unsigned int count;
+    unsigned int i;
+    double vmin;
+    double vmax;
+
+    errors = 0;
+    x = echart_data_absciss_get(snapshot);
+    a = echart_data_items_get(snapshot, 0);
+    b = echart_data_items_get(snapshot, 1);
+
+    /* the rows of a snapshot are complete and their count only grows */
+    count = echart_data_item_values_count(x);
+    if (count < *last)
+        errors++;
+    *last = count;
+    if ((echart_data_item_values_count(a) != count) ||
+        (echart_data_item_values_count(b) != count))
+        return errors + 1;
+
+    for (i = 0; i < count; i += 97)
+    {
+        if ((echart_data_item_value_get(x, i) != i) ||
+            (echart_data_item_value_get(a, i) != 2.0 * i) ||
+            (echart_data_item_value_get(b, i) != -1.0 * i))
+            errors++;
+    }
+
+    /* read from the level of detail of the writer */
+    if (count > 64)
+    {
+        echart_data_item_range_interval_get(a, 32, count - 16, &vmin, &vmax);
+        if ((vmin != 64.0) || (vmax != 2.0 * (count - 17)))
+            errors++;
+    }
+
+    return errors;
+}
+
+static void *
+_echart_stress_reader(void *data, Eina_Thread t EINA_UNUSED)
+{
+    Stress_Reader *reader;
+    unsigned int last;
+
+    reader = (Stress_Reader *)data;
+    last = 0;
+    while (!__atomic_load_n(&reader->stress->done, __ATOMIC_ACQUIRE))
+    {
+        Echart_Data *snapshot;
+
+        snapshot = echart_data_snapshot_new(reader->stress->data);
+        if (!snapshot)
+        {
+            reader->errors++;
+            continue;
+        }
+
+        reader->errors += _echart_stress_snapshot_check(snapshot, &last);
+        reader->snapshots++;
+        echart_data_free(snapshot);
+    }
+
+    return NULL;
+}
+
+int main(int argc, char *argv[])
+{
+    Stress stress;
+    Stress_Reader readers[READERS_MAX];
+    Eina_Thread threads[READERS_MAX];
+    Eina_Thread writer;
+    Echart_Data_Item *absciss;
+    Echart_Data_Item *items[2];
+    unsigned long snapshots;
+    unsigned long errors;
+    unsigned int readers_count;
+    unsigned int started;
+    unsigned int i;
+
+    readers_count = (argc > 1) ? (unsigned int)atoi(argv[1]) : 4;
+    if (!readers_count || (readers_count > READERS_MAX))
+        readers_count = 4;
+    stress.rows = (argc > 2) ? (unsigned int)atoi(argv[2]) : 200000;
+    stress.done = 0;
+
+    if (!echart_init())
+        return -1;
+
+    stress.data = echart_data_new();
+    absciss = echart_data_item_new();
+    items[0] = echart_data_item_new_typed(ECHART_VALUE_TYPE_FLOAT);
+    items[1] = echart_data_item_new_typed(ECHART_VALUE_TYPE_INT32);
+    echart_data_item_lod_set(items[0], EINA_TRUE);
+    echart_data_absciss_set(stress.data, absciss);
+    echart_data_items_set(stress.data, items[0]);
+    echart_data_items_set(stress.data, items[1]);
+    echart_data_shared_set(stress.data, EINA_TRUE);
+    if (!echart_data_shared_get(stress.data))
+    {
+        fprintf(stderr, "Could not share the data\n");
+        echart_shutdown();
+        return -1;
+    }
+
+    started = 0;
+    for (i = 0; i < readers_count; i++)
+    {
+        readers[started].stress = &stress;
+        readers[started].snapshots = 0;
+        readers[started].errors = 0;
+        if (!eina_thread_create(&threads[started], EINA_THREAD_NORMAL, -1,
+                                _echart_stress_reader, readers + started))
+            break;
+        started++;
+    }
+
+    if (!eina_thread_create(&writer, EINA_THREAD_NORMAL, -1,
+                            _echart_stress_writer, &stress))
+        _echart_stress_writer(&stress, 0);
+    else
+        eina_thread_join(writer);
+
+    snapshots = 0;
+    errors = 0;
+    for (i = 0; i < started; i++)
+    {
+        eina_thread_join(threads[i]);
+        snapshots += readers[i].snapshots;
+        errors += readers[i].errors;
+    }
+
+    if (echart_data_item_values_count(items[1]) != stress.rows)
+        errors++;
+
+    echart_data_shared_set(stress.data, EINA_FALSE);
+    if (echart_data_shared_get(stress.data))
+        errors++;
+
+    printf("%u readers, %u rows, %lu snapshots, %lu errors\n",
+           started, stress.rows, snapshots, errors);
+
+    echart_data_free(stress.data);
+    echart_data_item_free(items[1]);
+    echart_data_item_free(items[0]);
+    echart_data_item_free(absciss);
+
+    echart_shutdown();
+
+    return errors ? 1 : 0;
+}
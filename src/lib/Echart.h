@@ -54,6 +54,33 @@ typedef struct _Echart_Data_Item Echart_Data_Item;
 
 typedef struct _Echart_Colors Echart_Colors;
 
+typedef enum
+{
+    ECHART_DECIMATION_NONE,
+    ECHART_DECIMATION_MINMAX,
+    ECHART_DECIMATION_LTTB
+} Echart_Decimation;
+
+typedef enum
+{
+    ECHART_VALUE_TYPE_DOUBLE,
+    ECHART_VALUE_TYPE_FLOAT,
+    ECHART_VALUE_TYPE_INT32,
+    ECHART_VALUE_TYPE_INT64
+} Echart_Value_Type;
+
+typedef enum
+{
+    ECHART_CHANGE_NONE     = 0,
+    ECHART_CHANGE_STYLE    = 1 << 0,
+    ECHART_CHANGE_SIZE     = 1 << 1,
+    ECHART_CHANGE_VIEWPORT = 1 << 2,
+    ECHART_CHANGE_DATA     = 1 << 3,
+    ECHART_CHANGE_VALUES   = 1 << 4,
+    ECHART_CHANGE_RESET    = 1 << 5,
+    ECHART_CHANGE_SHIFT    = 1 << 6
+} Echart_Change;
+
 struct _Echart_Colors
 {
     Enesim_Argb line;
@@ -79,8 +106,13 @@ EAPI void echart_chart_sub_grid_color_set(Echart_Chart *chart, uint8_t a, uint8_
 EAPI Enesim_Argb echart_chart_sub_grid_color_get(const Echart_Chart *chart);
 EAPI void echart_chart_data_set(Echart_Chart *chart, Echart_Data *data);
 EAPI const Echart_Data *echart_chart_data_get(const Echart_Chart *chart);
+EAPI void echart_chart_viewport_set(Echart_Chart *chart, double xmin, double xmax);
+EAPI Eina_Bool echart_chart_viewport_get(const Echart_Chart *chart, double *xmin, double *xmax);
+EAPI unsigned int echart_chart_generation_get(const Echart_Chart *chart);
+EAPI Echart_Change echart_chart_changes_get(const Echart_Chart *chart, unsigned int generation);
 
 EAPI Echart_Data *echart_data_new(void);
+EAPI Echart_Data *echart_data_new_arena(size_t size_hint);
 EAPI void echart_data_free(Echart_Data *data);
 EAPI void echart_data_title_set(Echart_Data *data, const char *title);
 EAPI const char *echart_data_title_get(const Echart_Data *data);
@@ -89,16 +121,40 @@ EAPI const Echart_Data_Item *echart_data_absciss_get(const Echart_Data *data);
 EAPI void echart_data_items_set(Echart_Data *data, Echart_Data_Item *item);
 EAPI unsigned int echart_data_items_count(const Echart_Data *data);
 EAPI const Echart_Data_Item *echart_data_items_get(const Echart_Data *data, int idx);
+EAPI const Echart_Data_Item *echart_data_items_find(const Echart_Data *data, const char *title);
+EAPI void echart_data_ring_set(Echart_Data *data, unsigned int capacity);
+EAPI void echart_data_values_push(Echart_Data *data, double absciss, const double *values);
+EAPI unsigned int echart_data_generation_get(const Echart_Data *data);
+EAPI Echart_Change echart_data_changes_get(const Echart_Data *data, unsigned int generation);
+EAPI void echart_data_shared_set(Echart_Data *data, Eina_Bool shared);
+EAPI Eina_Bool echart_data_shared_get(const Echart_Data *data);
+EAPI Echart_Data *echart_data_snapshot_new(const Echart_Data *data);
 
 EAPI Echart_Data_Item *echart_data_item_new(void);
+EAPI Echart_Data_Item *echart_data_item_new_typed(Echart_Value_Type type);
+EAPI Echart_Data_Item *echart_data_item_new_arena(Echart_Data *data, Echart_Value_Type type);
 EAPI void echart_data_item_free(Echart_Data_Item *item);
 EAPI void echart_data_item_title_set(Echart_Data_Item *item, const char *title);
 EAPI const char *echart_data_item_title_get(const Echart_Data_Item *item);
 EAPI void echart_data_item_color_set(Echart_Data_Item *item, uint8_t a, uint8_t r, uint8_t g, uint8_t b);
 EAPI Echart_Colors echart_data_item_color_get(const Echart_Data_Item *item);
 EAPI void echart_data_item_value_add(Echart_Data_Item *item, double d);
+EAPI void echart_data_item_values_add(Echart_Data_Item *item, const double *values, size_t count);
+EAPI unsigned int echart_data_item_values_count(const Echart_Data_Item *item);
+EAPI void echart_data_item_values_bind(Echart_Data_Item *item, const void *values, size_t count, size_t stride, Echart_Value_Type type, Eina_Free_Cb free_cb);
+EAPI void echart_data_item_ring_set(Echart_Data_Item *item, unsigned int capacity);
+EAPI unsigned int echart_data_item_ring_get(const Echart_Data_Item *item);
+EAPI void echart_data_item_compressed_set(Echart_Data_Item *item, Eina_Bool compressed);
+EAPI Eina_Bool echart_data_item_compressed_get(const Echart_Data_Item *item);
+EAPI void echart_data_item_lod_set(Echart_Data_Item *item, Eina_Bool lod);
+EAPI Eina_Bool echart_data_item_lod_get(const Echart_Data_Item *item);
+EAPI double echart_data_item_value_get(const Echart_Data_Item *item, unsigned int idx);
+EAPI const double *echart_data_item_values_array_get(const Echart_Data_Item *item);
 EAPI const Eina_List *echart_data_item_values_get(const Echart_Data_Item *item);
 EAPI void echart_data_item_interval_get(const Echart_Data_Item *item, double *vmin, double *vmax);
+EAPI Eina_Bool echart_data_item_range_interval_get(const Echart_Data_Item *item, unsigned int i0, unsigned int i1, double *vmin, double *vmax);
+EAPI unsigned int echart_data_item_generation_get(const Echart_Data_Item *item);
+EAPI Echart_Change echart_data_item_changes_get(const Echart_Data_Item *item, unsigned int generation, unsigned int count, unsigned int *first, unsigned int *nbr);
 
 EAPI Echart_Line *echart_line_new(void);
 EAPI void echart_line_chart_free(Echart_Line *line);
@@ -108,12 +164,19 @@ EAPI void echart_line_area_set(Echart_Line *line, Eina_Bool area);
 EAPI Eina_Bool echart_line_area_get(const Echart_Line *line);
 EAPI void echart_line_stacked_set(Echart_Line *line, Eina_Bool stacked);
 EAPI Eina_Bool echart_line_stacked_get(const Echart_Line *line);
-EAPI Enesim_Renderer *echart_line_renderer_get(const Echart_Line *line);
+EAPI void echart_line_decimation_set(Echart_Line *line, Echart_Decimation decimation);
+EAPI Echart_Decimation echart_line_decimation_get(const Echart_Line *line);
+EAPI void echart_line_stroke_weight_set(Echart_Line *line, double weight);
+EAPI double echart_line_stroke_weight_get(const Echart_Line *line);
+EAPI Eina_Bool echart_line_update(Echart_Line *line);
+EAPI Enesim_Renderer *echart_line_renderer_get(Echart_Line *line);
 
 EAPI Echart_Column * echart_column_new(void);
 EAPI void echart_column_chart_free(Echart_Column *thiz);
 EAPI Enesim_Renderer * echart_column_renderer_get(Echart_Column *thiz);
 EAPI void echart_column_chart_set(Echart_Column *thiz, const Echart_Chart *chart);
 
+EAPI Eina_Bool echart_render(Enesim_Renderer *scene, Enesim_Surface *surface, unsigned int n_threads);
+
 
 #endif
@@ -5,11 +5,26 @@ includes_HEADERS = src/lib/Echart.h
 includesdir = $(pkgincludedir)-@VMAJ@
 
 src_lib_libechart_la_SOURCES = \
+src/lib/echart_area.c \
+src/lib/echart_arena.c \
+src/lib/echart_axis.c \
+src/lib/echart_bar.c \
+src/lib/echart_canvas.c \
 src/lib/echart_chart.c \
+src/lib/echart_codec.c \
 src/lib/echart_column.c \
 src/lib/echart_data.c \
+src/lib/echart_decimate.c \
+src/lib/echart_font.c \
+src/lib/echart_grid.c \
+src/lib/echart_label.c \
 src/lib/echart_line.c \
+src/lib/echart_lod.c \
 src/lib/echart_main.c \
+src/lib/echart_polyline.c \
+src/lib/echart_render.c \
+src/lib/echart_shared.c \
+src/lib/echart_simd.c \
 src/lib/echart_private.h
 
 src_lib_libechart_la_CPPFLAGS = \
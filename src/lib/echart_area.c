@@ -0,0 +1,505 @@
+/* Echart - Chart rendering library
+ * Copyright (C) 2013 Vincent Torri
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <limits.h>
+#include <math.h>
+#include <string.h>
+
+#include <Enesim.h>
+
+#include "Echart.h"
+#include "echart_private.h"
+
+/*============================================================================*
+ *                                  Local                                     *
+ *============================================================================*/
+
+/**
+ * @cond LOCAL
+ */
+
+typedef struct _Echart_Area Echart_Area;
+
+/*
+ * The area between the curve (x[k], y[k]), x being increasing, and the
+ * horizontal line at base, below it.
+ */
+struct _Echart_Area
+{
+    double *x;
+    double *y;
+    unsigned int count;
+    unsigned int alloc;
+    double base;
+    Enesim_Color color;
+    /* the current column: first segment, rows partially and fully covered */
+    unsigned int k;
+    int p0;
+    int f0;
+    int f1;
+    int e;
+};
+
+/*
+ * All the areas of a chart, filled in a single pass over the columns of a
+ * canvas covering them, the areas being blended in their order. In a
+ * column, the rows between two consecutive curves are covered by the same
+ * areas, so their color is computed once, only the rows crossed by a curve
+ * or a base being computed per pixel.
+ */
+struct _Echart_Areas
+{
+    Echart_Area *areas;
+    unsigned int count;
+    unsigned int dirty : 1;
+    Echart_Canvas canvas;
+};
+
+/* the primitive of clamp(u, 0, h) */
+static inline double
+_echart_area_primitive(double u, double h)
+{
+    if (u <= 0)
+        return 0;
+    if (u <= h)
+        return u * u / 2;
+    return h * u - h * h / 2;
+}
+
+/*
+ * the coverage of the pixel of the row i in the column c by the area,
+ * exact for the segments of its curve: over a segment, the covered height
+ * of the row is clamp(top - y, 0, top - i) with y linear, whose mean is
+ * given by its primitive
+ */
+static double
+_echart_area_coverage_get(const Echart_Area *area, int c, int i)
+{
+    double cov;
+    double top;
+    double h;
+    unsigned int k;
+
+    top = (i + 1 < area->base) ? i + 1 : area->base;
+    h = top - i;
+    if (h <= 0)
+        return 0;
+
+    cov = 0;
+    for (k = area->k; (k + 1 < area->count) && (area->x[k] < c + 1); k++)
+    {
+        double slope;
+        double xa;
+        double xb;
+        double g0;
+        double g1;
+
+        if (area->x[k + 1] <= area->x[k])
+            continue;
+
+        xa = (area->x[k] > c) ? area->x[k] : c;
+        xb = (area->x[k + 1] < c + 1) ? area->x[k + 1] : c + 1;
+        if (xb <= xa)
+            continue;
+
+        slope = (area->y[k + 1] - area->y[k]) / (area->x[k + 1] - area->x[k]);
+        g0 = top - (area->y[k] + slope * (xa - area->x[k]));
+        g1 = top - (area->y[k] + slope * (xb - area->x[k]));
+        if (fabs(g1 - g0) < 1e-9)
+            cov += (xb - xa) * ((g0 <= 0) ? 0 : (g0 < h) ? g0 : h);
+        else
+            cov += (xb - xa) * (_echart_area_primitive(g1, h) - _echart_area_primitive(g0, h)) / (g1 - g0);
+    }
+
+    return cov;
+}
+
+/*
+ * the rows of the column c covered by the area: partially in [p0, e)
+ * except [f0, f1), which is fully covered
+ */
+static void
+_echart_area_column_set(Echart_Area *area, int c)
+{
+    double ymin;
+    double ymax;
+    double w;
+    unsigned int k;
+
+    while ((area->k + 1 < area->count) && (area->x[area->k + 1] <= c))
+        area->k++;
+
+    ymin = HUGE_VAL;
+    ymax = -HUGE_VAL;
+    w = 0;
+    for (k = area->k; (k + 1 < area->count) && (area->x[k] < c + 1); k++)
+    {
+        double slope;
+        double xa;
+        double xb;
+        double ya;
+        double yb;
+
+        if (area->x[k + 1] <= area->x[k])
+            continue;
+
+        xa = (area->x[k] > c) ? area->x[k] : c;
+        xb = (area->x[k + 1] < c + 1) ? area->x[k + 1] : c + 1;
+        if (xb <= xa)
+            continue;
+
+        slope = (area->y[k + 1] - area->y[k]) / (area->x[k + 1] - area->x[k]);
+        ya = area->y[k] + slope * (xa - area->x[k]);
+        yb = area->y[k] + slope * (xb - area->x[k]);
+        if (ymin > ya) ymin = ya;
+        if (ymin > yb) ymin = yb;
+        if (ymax < ya) ymax = ya;
+        if (ymax < yb) ymax = yb;
+        w += xb - xa;
+    }
+
+    if (w <= 0)
+    {
+        area->p0 = area->f0 = area->f1 = area->e = 0;
+        return;
+    }
+
+    area->p0 = (int)floor(ymin);
+    area->e = (int)ceil(area->base);
+    area->f0 = (int)ceil(ymax);
+    area->f1 = (int)floor(area->base);
+    /* the ends of the curve only cover a part of their column */
+    if ((w < 1.0 - 1e-9) || (area->f0 >= area->f1))
+        area->f0 = area->f1 = area->e;
+}
+
+/* the areas blended over the pixel of the row i of the column c */
+static Enesim_Color
+_echart_areas_pixel_get(const Echart_Areas *areas, int c, int i)
+{
+    Enesim_Color dst;
+    unsigned int s;
+
+    dst = 0;
+    for (s = 0; s < areas->count; s++)
+    {
+        const Echart_Area *area;
+        Enesim_Color src;
+        double cov;
+
+        area = areas->areas + s;
+        if ((i < area->p0) || (i >= area->e))
+            continue;
+
+        if ((i >= area->f0) && (i < area->f1))
+            src = area->color;
+        else
+        {
+            cov = _echart_area_coverage_get(area, c, i);
+            if (cov <= 0)
+                continue;
+            src = ECHART_ARGB_MUL_256((uint32_t)(cov * 256 + 0.5), area->color);
+        }
+        dst = src + ECHART_ARGB_MUL_256(256 - (src >> 24), dst);
+    }
+
+    return dst;
+}
+
+/*
+ * the first row after i where an area starts or stops to be partially or
+ * fully covered, or -1 if an area partially covers the row i
+ */
+static int
+_echart_areas_span_end_get(const Echart_Areas *areas, int i)
+{
+    unsigned int s;
+    int end;
+
+    end = INT_MAX;
+    for (s = 0; s < areas->count; s++)
+    {
+        const Echart_Area *area;
+
+        area = areas->areas + s;
+        if ((i >= area->p0) && (i < area->e) && ((i < area->f0) || (i >= area->f1)))
+            return -1;
+
+        if ((i < area->p0) && (area->p0 < end))
+            end = area->p0;
+        else if ((i < area->f1) && (area->f1 < end))
+            end = area->f1;
+        else if ((i < area->e) && (area->e < end))
+            end = area->e;
+    }
+
+    return end;
+}
+
+/**
+ * @endcond
+ */
+
+/*============================================================================*
+ *                                 Global                                     *
+ *============================================================================*/
+
+Echart_Areas *
+echart_areas_new(void)
+{
+    Echart_Areas *areas;
+
+    areas = (Echart_Areas *)calloc(1, sizeof(Echart_Areas));
+    if (!areas)
+        return NULL;
+
+    if (!echart_canvas_init(&areas->canvas))
+    {
+        free(areas);
+        return NULL;
+    }
+
+    return areas;
+}
+
+void
+echart_areas_free(Echart_Areas *areas)
+{
+    if (!areas)
+        return;
+
+    echart_areas_count_set(areas, 0);
+    echart_canvas_shutdown(&areas->canvas);
+    free(areas);
+}
+
+/* the number of areas, the new ones being empty and transparent */
+Eina_Bool
+echart_areas_count_set(Echart_Areas *areas, unsigned int count)
+{
+    Echart_Area *tmp;
+    unsigned int s;
+
+    if (count == areas->count)
+        return EINA_TRUE;
+
+    for (s = count; s < areas->count; s++)
+    {
+        free(areas->areas[s].x);
+        free(areas->areas[s].y);
+    }
+    if (count < areas->count)
+        areas->count = count;
+
+    if (!count)
+    {
+        free(areas->areas);
+        areas->areas = NULL;
+        areas->dirty = 1;
+        return EINA_TRUE;
+    }
+
+    tmp = (Echart_Area *)realloc(areas->areas, count * sizeof(Echart_Area));
+    if (!tmp)
+        return EINA_FALSE;
+
+    if (count > areas->count)
+        memset(tmp + areas->count, 0, (count - areas->count) * sizeof(Echart_Area));
+    areas->areas = tmp;
+    areas->count = count;
+    areas->dirty = 1;
+
+    return EINA_TRUE;
+}
+
+/*
+ * the area s between the curve of the n points (x[k], y[k]), x being
+ * increasing, and the horizontal line at base, in the coordinates of the
+ * chart. Like the closed path it replaces, the curve goes down to the base
+ * at x0 before its first point and at x1 after its last one. The points
+ * are copied.
+ */
+Eina_Bool
+echart_areas_set(Echart_Areas *areas, unsigned int s, const double *x, const double *y, unsigned int n, double base, double x0, double x1)
+{
+    Echart_Area *area;
+    unsigned int first;
+    unsigned int last;
+    unsigned int count;
+    unsigned int k;
+
+    area = areas->areas + s;
+    first = (n && (x0 < x[0])) ? 1 : 0;
+    last = (n && (x[n - 1] < x1)) ? 1 : 0;
+    count = first + n + last;
+    if (count > area->alloc)
+    {
+        double *tmp;
+
+        tmp = (double *)realloc(area->x, count * sizeof(double));
+        if (!tmp)
+            return EINA_FALSE;
+        area->x = tmp;
+
+        tmp = (double *)realloc(area->y, count * sizeof(double));
+        if (!tmp)
+            return EINA_FALSE;
+        area->y = tmp;
+        area->alloc = count;
+    }
+
+    if (first)
+    {
+        area->x[0] = x0;
+        area->y[0] = base;
+    }
+    if (n)
+        memcpy(area->x + first, x, n * sizeof(double));
+    /* the area is below its curve */
+    for (k = 0; k < n; k++)
+        area->y[first + k] = (y[k] < base) ? y[k] : base;
+    if (last)
+    {
+        area->x[first + n] = x1;
+        area->y[first + n] = base;
+    }
+    area->count = count;
+    area->base = base;
+    areas->dirty = 1;
+
+    return EINA_TRUE;
+}
+
+/* the color of the area s, premultiplied */
+void
+echart_areas_color_set(Echart_Areas *areas, unsigned int s, Enesim_Color color)
+{
+    if (areas->areas[s].color == color)
+        return;
+
+    areas->areas[s].color = color;
+    areas->dirty = 1;
+}
+
+/*
+ * Fills the areas in a canvas covering them, if they changed since the
+ * last update.
+ */
+Eina_Bool
+echart_areas_update(Echart_Areas *areas)
+{
+    Echart_Canvas *canvas;
+    unsigned int s;
+    double x0;
+    double y0;
+    double x1;
+    double y1;
+    int c;
+    int i;
+
+    if (!areas->dirty)
+        return EINA_TRUE;
+
+    x0 = y0 = HUGE_VAL;
+    x1 = y1 = -HUGE_VAL;
+    for (s = 0; s < areas->count; s++)
+    {
+        const Echart_Area *area;
+        double vmin;
+        double vmax;
+
+        area = areas->areas + s;
+        if (area->count < 2)
+            continue;
+
+        /* x is increasing */
+        if (x0 > area->x[0])
+            x0 = area->x[0];
+        if (x1 < area->x[area->count - 1])
+            x1 = area->x[area->count - 1];
+        echart_simd_interval_get(area->y, area->count, &vmin, &vmax);
+        if (y0 > vmin)
+            y0 = vmin;
+        if (y1 < area->base)
+            y1 = area->base;
+    }
+    if (x0 > x1)
+        x0 = y0 = x1 = y1 = 0;
+
+    canvas = &areas->canvas;
+    if (!echart_canvas_begin(canvas,
+                             (int)floor(x0), (int)floor(y0),
+                             (int)(ceil(x1) - floor(x0)), (int)(ceil(y1) - floor(y0))))
+        return EINA_FALSE;
+
+    for (s = 0; s < areas->count; s++)
+        areas->areas[s].k = 0;
+
+    for (c = 0; (c < canvas->w) && canvas->pixels; c++)
+    {
+        int i0;
+        int i1;
+
+        i0 = INT_MAX;
+        i1 = INT_MIN;
+        for (s = 0; s < areas->count; s++)
+        {
+            Echart_Area *area;
+
+            area = areas->areas + s;
+            _echart_area_column_set(area, canvas->x + c);
+            if (area->p0 >= area->e)
+                continue;
+            if (i0 > area->p0)
+                i0 = area->p0;
+            if (i1 < area->e)
+                i1 = area->e;
+        }
+
+        i = i0;
+        while (i < i1)
+        {
+            Enesim_Color color;
+            int end;
+
+            color = _echart_areas_pixel_get(areas, canvas->x + c, i);
+            end = _echart_areas_span_end_get(areas, i);
+            if ((end < 0) || (end > i1))
+                end = (end < 0) ? i + 1 : i1;
+
+            for (; i < end; i++)
+                echart_canvas_span_blend(canvas, c, i - canvas->y, 1, 256, color);
+        }
+    }
+
+    echart_canvas_end(canvas);
+    areas->dirty = 0;
+
+    return EINA_TRUE;
+}
+
+/* the renderer is owned by the areas, a reference must be taken to keep it */
+Enesim_Renderer *
+echart_areas_renderer_get(const Echart_Areas *areas)
+{
+    return areas->canvas.renderer;
+}
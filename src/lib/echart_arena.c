@@ -0,0 +1,207 @@
+/* Echart - Chart rendering library
+ * Copyright (C) 2013 Vincent Torri
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <Enesim.h>
+
+#include "Echart.h"
+#include "echart_private.h"
+
+/*============================================================================*
+ *                                  Local                                     *
+ *============================================================================*/
+
+/**
+ * @cond LOCAL
+ */
+
+/*
+ * The arena is a list of chunks in which the blocks are allocated by bumping
+ * an offset. Blocks are never freed individually, the whole arena is
+ * released at once.
+ */
+#define ECHART_ARENA_ALIGN 16
+#define ECHART_ARENA_CHUNK_SIZE 4096
+
+#define ECHART_ARENA_ROUND(s) (((s) + ECHART_ARENA_ALIGN - 1) & ~((size_t)ECHART_ARENA_ALIGN - 1))
+
+typedef struct _Echart_Arena_Chunk Echart_Arena_Chunk;
+
+struct _Echart_Arena_Chunk
+{
+    Echart_Arena_Chunk *next;
+    size_t size;
+    size_t used;
+    /* offset of the last block, which can be grown in place */
+    size_t last;
+};
+
+struct _Echart_Arena
+{
+    Echart_Arena_Chunk *chunks;
+    size_t chunk_size;
+};
+
+#define ECHART_ARENA_CHUNK_DATA(c) ((unsigned char *)(c) + ECHART_ARENA_ROUND(sizeof(Echart_Arena_Chunk)))
+
+static Echart_Arena_Chunk *
+_echart_arena_chunk_new(Echart_Arena *arena, size_t size)
+{
+    Echart_Arena_Chunk *chunk;
+
+    if (size < arena->chunk_size)
+        size = arena->chunk_size;
+
+    chunk = (Echart_Arena_Chunk *)malloc(ECHART_ARENA_ROUND(sizeof(Echart_Arena_Chunk)) + size);
+    if (!chunk)
+        return NULL;
+
+    chunk->next = arena->chunks;
+    chunk->size = size;
+    chunk->used = 0;
+    chunk->last = 0;
+    arena->chunks = chunk;
+
+    return chunk;
+}
+
+/**
+ * @endcond
+ */
+
+/*============================================================================*
+ *                                 Global                                     *
+ *============================================================================*/
+
+Echart_Arena *
+echart_arena_new(size_t size_hint)
+{
+    Echart_Arena *arena;
+
+    arena = (Echart_Arena *)calloc(1, sizeof(Echart_Arena));
+    if (!arena)
+        return NULL;
+
+    arena->chunk_size = ECHART_ARENA_ROUND(size_hint);
+    if (arena->chunk_size < ECHART_ARENA_CHUNK_SIZE)
+        arena->chunk_size = ECHART_ARENA_CHUNK_SIZE;
+
+    if (!_echart_arena_chunk_new(arena, arena->chunk_size))
+    {
+        free(arena);
+        return NULL;
+    }
+
+    return arena;
+}
+
+void
+echart_arena_free(Echart_Arena *arena)
+{
+    Echart_Arena_Chunk *chunk;
+
+    if (!arena)
+        return;
+
+    chunk = arena->chunks;
+    while (chunk)
+    {
+        Echart_Arena_Chunk *next;
+
+        next = chunk->next;
+        free(chunk);
+        chunk = next;
+    }
+    free(arena);
+}
+
+/* the returned block is zeroed */
+void *
+echart_arena_alloc(Echart_Arena *arena, size_t size)
+{
+    Echart_Arena_Chunk *chunk;
+    unsigned char *block;
+
+    size = ECHART_ARENA_ROUND(size ? size : 1);
+    chunk = arena->chunks;
+    if (chunk->used + size > chunk->size)
+    {
+        /* later chunks grow with the arena */
+        if (arena->chunk_size < (((size_t)-1) >> 2))
+            arena->chunk_size *= 2;
+        chunk = _echart_arena_chunk_new(arena, size);
+        if (!chunk)
+            return NULL;
+    }
+
+    block = ECHART_ARENA_CHUNK_DATA(chunk) + chunk->used;
+    chunk->last = chunk->used;
+    chunk->used += size;
+    memset(block, 0, size);
+
+    return block;
+}
+
+/*
+ * the last allocated block is grown in place when the chunk has room
+ * left, otherwise a new block is allocated and the old one is abandoned
+ */
+void *
+echart_arena_realloc(Echart_Arena *arena, void *ptr, size_t old_size, size_t size)
+{
+    Echart_Arena_Chunk *chunk;
+    void *block;
+
+    if (!ptr)
+        return echart_arena_alloc(arena, size);
+
+    chunk = arena->chunks;
+    if (((unsigned char *)ptr == ECHART_ARENA_CHUNK_DATA(chunk) + chunk->last) &&
+        (chunk->last + ECHART_ARENA_ROUND(size) <= chunk->size))
+    {
+        chunk->used = chunk->last + ECHART_ARENA_ROUND(size);
+        return ptr;
+    }
+
+    block = echart_arena_alloc(arena, size);
+    if (!block)
+        return NULL;
+
+    memcpy(block, ptr, (old_size < size) ? old_size : size);
+
+    return block;
+}
+
+char *
+echart_arena_strdup(Echart_Arena *arena, const char *str)
+{
+    char *s;
+    size_t l;
+
+    l = strlen(str) + 1;
+    s = (char *)echart_arena_alloc(arena, l);
+    if (!s)
+        return NULL;
+
+    memcpy(s, str, l);
+
+    return s;
+}
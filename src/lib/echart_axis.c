@@ -0,0 +1,83 @@
+/* Echart - Chart rendering library
+ * Copyright (C) 2013 Vincent Torri
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <math.h>
+
+#include <Enesim.h>
+
+#include "Echart.h"
+#include "echart_private.h"
+
+/*============================================================================*
+ *                                  Local                                     *
+ *============================================================================*/
+
+/*============================================================================*
+ *                                 Global                                     *
+ *============================================================================*/
+
+/*
+ * The ticks of [vmin, vmax] are spaced by a "nice" step, 1, 2 or 5 times a
+ * power of 10, the smallest one giving at most max + 1 ticks. Returns the
+ * number of ticks, first being set to the first one.
+ */
+unsigned int
+echart_axis_ticks_get(double vmin, double vmax, unsigned int max, double *first, double *step)
+{
+    double magnitude;
+    double raw;
+    double s;
+
+    if (!(vmax > vmin) || !max)
+        return 0;
+
+    raw = (vmax - vmin) / max;
+    magnitude = pow(10.0, floor(log10(raw)));
+    raw /= magnitude;
+    if (raw <= 1.0)
+        s = 1.0;
+    else if (raw <= 2.0)
+        s = 2.0;
+    else if (raw <= 5.0)
+        s = 5.0;
+    else
+        s = 10.0;
+    s *= magnitude;
+
+    *first = ceil(vmin / s) * s;
+    *step = s;
+
+    if (*first > vmax)
+        return 0;
+
+    return (unsigned int)floor((vmax - *first) / s + 1e-9) + 1;
+}
+
+/* the decimals needed by the labels of ticks spaced by step */
+int
+echart_axis_decimals_get(double step)
+{
+    if (step >= 1.0)
+        return 0;
+
+    return (int)ceil(-log10(step) - 1e-9);
+}
@@ -0,0 +1,312 @@
+/* Echart - Chart rendering library
+ * Copyright (C) 2013 Vincent Torri
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <math.h>
+#include <string.h>
+
+#include <Enesim.h>
+
+#include "Echart.h"
+#include "echart_private.h"
+
+/*============================================================================*
+ *                                  Local                                     *
+ *============================================================================*/
+
+/**
+ * @cond LOCAL
+ */
+
+typedef struct _Echart_Bar Echart_Bar;
+
+struct _Echart_Bar
+{
+    double x;
+    double w;
+    /* y0 <= y1 */
+    double y0;
+    double y1;
+    unsigned int color;
+};
+
+/*
+ * All the bars of a chart, filled in a single pass over the rows of a
+ * canvas covering them. The bars are sorted by their top, so that each row
+ * only visits the bars crossing it.
+ */
+struct _Echart_Bars
+{
+    Echart_Bar *bars;
+    unsigned int count;
+    unsigned int alloc;
+    /* the bars crossing the current row */
+    unsigned int *active;
+    Enesim_Color *palette;
+    unsigned int palette_count;
+    Echart_Canvas canvas;
+};
+
+static int
+_echart_bar_cmp(const void *p1, const void *p2)
+{
+    const Echart_Bar *b1 = (const Echart_Bar *)p1;
+    const Echart_Bar *b2 = (const Echart_Bar *)p2;
+
+    if (b1->y0 < b2->y0)
+        return -1;
+    if (b1->y0 > b2->y0)
+        return 1;
+    return 0;
+}
+
+/* the length of [a0, a1] inside [b0, b1] */
+static inline double
+_echart_bar_overlap(double a0, double a1, double b0, double b1)
+{
+    if (a0 < b0)
+        a0 = b0;
+    if (a1 > b1)
+        a1 = b1;
+
+    return (a1 > a0) ? a1 - a0 : 0.0;
+}
+
+/*
+ * the part of the bar in the row y of the canvas, vc being its vertical
+ * coverage: the partial pixels of its sides, and a span in between
+ */
+static void
+_echart_bar_row_draw(Echart_Canvas *canvas, const Echart_Bar *bar, int y, double vc, Enesim_Color color)
+{
+    double x0;
+    double x1;
+    int ix0;
+    int ix1;
+
+    x0 = bar->x - canvas->x;
+    x1 = x0 + bar->w;
+    ix0 = (int)floor(x0);
+    ix1 = (int)floor(x1);
+
+    if (ix0 == ix1)
+    {
+        echart_canvas_span_blend(canvas, ix0, y, 1, (uint32_t)((x1 - x0) * vc * 256 + 0.5), color);
+        return;
+    }
+
+    echart_canvas_span_blend(canvas, ix0, y, 1, (uint32_t)((ix0 + 1 - x0) * vc * 256 + 0.5), color);
+    echart_canvas_span_blend(canvas, ix0 + 1, y, ix1 - ix0 - 1, (uint32_t)(vc * 256 + 0.5), color);
+    echart_canvas_span_blend(canvas, ix1, y, 1, (uint32_t)((x1 - ix1) * vc * 256 + 0.5), color);
+}
+
+/**
+ * @endcond
+ */
+
+/*============================================================================*
+ *                                 Global                                     *
+ *============================================================================*/
+
+Echart_Bars *
+echart_bars_new(void)
+{
+    Echart_Bars *bars;
+
+    bars = (Echart_Bars *)calloc(1, sizeof(Echart_Bars));
+    if (!bars)
+        return NULL;
+
+    if (!echart_canvas_init(&bars->canvas))
+    {
+        free(bars);
+        return NULL;
+    }
+
+    return bars;
+}
+
+void
+echart_bars_free(Echart_Bars *bars)
+{
+    if (!bars)
+        return;
+
+    echart_canvas_shutdown(&bars->canvas);
+    free(bars->palette);
+    free(bars->active);
+    free(bars->bars);
+    free(bars);
+}
+
+void
+echart_bars_clear(Echart_Bars *bars)
+{
+    bars->count = 0;
+}
+
+/* the colors of the bars, premultiplied, indexed by echart_bars_add() */
+Eina_Bool
+echart_bars_palette_set(Echart_Bars *bars, const Enesim_Color *colors, unsigned int count)
+{
+    Enesim_Color *palette;
+
+    palette = (Enesim_Color *)realloc(bars->palette, count * sizeof(Enesim_Color));
+    if (!palette && count)
+        return EINA_FALSE;
+
+    if (count)
+        memcpy(palette, colors, count * sizeof(Enesim_Color));
+    bars->palette = palette;
+    bars->palette_count = count;
+
+    return EINA_TRUE;
+}
+
+/* the bar from (x, y0) to (x + w, y1), in the coordinates of the chart */
+Eina_Bool
+echart_bars_add(Echart_Bars *bars, double x, double w, double y0, double y1, unsigned int color)
+{
+    Echart_Bar *bar;
+
+    if ((w <= 0) || (y0 == y1) || (color >= bars->palette_count))
+        return EINA_TRUE;
+
+    if (bars->count == bars->alloc)
+    {
+        Echart_Bar *tmp;
+        unsigned int *active;
+        unsigned int alloc;
+
+        alloc = bars->alloc ? 2 * bars->alloc : 64;
+        tmp = (Echart_Bar *)realloc(bars->bars, alloc * sizeof(Echart_Bar));
+        if (!tmp)
+            return EINA_FALSE;
+        bars->bars = tmp;
+
+        active = (unsigned int *)realloc(bars->active, alloc * sizeof(unsigned int));
+        if (!active)
+            return EINA_FALSE;
+        bars->active = active;
+        bars->alloc = alloc;
+    }
+
+    bar = bars->bars + bars->count;
+    bar->x = x;
+    bar->w = w;
+    bar->y0 = (y0 < y1) ? y0 : y1;
+    bar->y1 = (y0 < y1) ? y1 : y0;
+    bar->color = color;
+    bars->count++;
+
+    return EINA_TRUE;
+}
+
+/*
+ * Fills the bars in a canvas covering them. The rows are drawn from the
+ * top, the bars starting above a row being added to the active ones, and
+ * the ones ending above it removed.
+ */
+Eina_Bool
+echart_bars_update(Echart_Bars *bars)
+{
+    Echart_Canvas *canvas;
+    unsigned int next;
+    unsigned int nactive;
+    unsigned int i;
+    double x0;
+    double y0;
+    double x1;
+    double y1;
+    int row;
+
+    x0 = y0 = x1 = y1 = 0;
+    if (bars->count)
+    {
+        x0 = y0 = HUGE_VAL;
+        x1 = y1 = -HUGE_VAL;
+        for (i = 0; i < bars->count; i++)
+        {
+            const Echart_Bar *bar;
+
+            bar = bars->bars + i;
+            if (x0 > bar->x)
+                x0 = bar->x;
+            if (x1 < bar->x + bar->w)
+                x1 = bar->x + bar->w;
+            if (y0 > bar->y0)
+                y0 = bar->y0;
+            if (y1 < bar->y1)
+                y1 = bar->y1;
+        }
+        x0 = floor(x0);
+        y0 = floor(y0);
+        x1 = ceil(x1);
+        y1 = ceil(y1);
+    }
+
+    canvas = &bars->canvas;
+    if (!echart_canvas_begin(canvas, (int)x0, (int)y0, (int)(x1 - x0), (int)(y1 - y0)))
+        return EINA_FALSE;
+
+    if (bars->count)
+        qsort(bars->bars, bars->count, sizeof(Echart_Bar), _echart_bar_cmp);
+
+    next = 0;
+    nactive = 0;
+    for (row = 0; row < canvas->h; row++)
+    {
+        double y;
+
+        y = canvas->y + row;
+        while ((next < bars->count) && (bars->bars[next].y0 < y + 1))
+            bars->active[nactive++] = next++;
+
+        i = 0;
+        while (i < nactive)
+        {
+            const Echart_Bar *bar;
+
+            bar = bars->bars + bars->active[i];
+            if (bar->y1 <= y)
+            {
+                bars->active[i] = bars->active[--nactive];
+                continue;
+            }
+
+            _echart_bar_row_draw(canvas, bar, row,
+                                 _echart_bar_overlap(bar->y0, bar->y1, y, y + 1),
+                                 bars->palette[bar->color]);
+            i++;
+        }
+    }
+
+    echart_canvas_end(canvas);
+
+    return EINA_TRUE;
+}
+
+/* the renderer is owned by the bars, a reference must be taken to keep it */
+Enesim_Renderer *
+echart_bars_renderer_get(const Echart_Bars *bars)
+{
+    return bars->canvas.renderer;
+}
@@ -0,0 +1,172 @@
+/* Echart - Chart rendering library
+ * Copyright (C) 2013 Vincent Torri
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <string.h>
+
+#include <Enesim.h>
+
+#include "Echart.h"
+#include "echart_private.h"
+
+/*============================================================================*
+ *                                  Local                                     *
+ *============================================================================*/
+
+/*============================================================================*
+ *                                 Global                                     *
+ *============================================================================*/
+
+/*
+ * A canvas is a surface drawn by the library itself, covering a box of
+ * the chart, and the image renderer showing it. It lets the elements with
+ * a lot of primitives (labels, grid, bars...) be a single layer of the
+ * compound.
+ */
+Eina_Bool
+echart_canvas_init(Echart_Canvas *canvas)
+{
+    memset(canvas, 0, sizeof(Echart_Canvas));
+    canvas->renderer = enesim_renderer_image_new();
+
+    return canvas->renderer != NULL;
+}
+
+void
+echart_canvas_shutdown(Echart_Canvas *canvas)
+{
+    if (canvas->surface)
+        enesim_surface_unref(canvas->surface);
+    if (canvas->renderer)
+        enesim_renderer_unref(canvas->renderer);
+    memset(canvas, 0, sizeof(Echart_Canvas));
+}
+
+/*
+ * Starts the drawing in the box at (x, y) of size w x h, cleared. The
+ * surface is kept while the box keeps its size. An empty box gives no
+ * pixels, the drawing functions doing nothing then.
+ */
+Eina_Bool
+echart_canvas_begin(Echart_Canvas *canvas, int x, int y, int w, int h)
+{
+    void *data;
+    int j;
+
+    canvas->pixels = NULL;
+    canvas->x = x;
+    canvas->y = y;
+    if ((w <= 0) || (h <= 0))
+    {
+        canvas->w = canvas->h = 0;
+        return EINA_TRUE;
+    }
+
+    if (!canvas->surface || (canvas->w != w) || (canvas->h != h))
+    {
+        if (canvas->surface)
+            enesim_surface_unref(canvas->surface);
+        canvas->surface = enesim_surface_new(ENESIM_FORMAT_ARGB8888, w, h);
+        if (!canvas->surface)
+        {
+            canvas->w = canvas->h = 0;
+            return EINA_FALSE;
+        }
+    }
+    canvas->w = w;
+    canvas->h = h;
+
+    if (!enesim_surface_lock(canvas->surface, EINA_TRUE))
+        return EINA_FALSE;
+
+    if (!enesim_surface_data_get(canvas->surface, &data, &canvas->stride))
+    {
+        enesim_surface_unlock(canvas->surface);
+        return EINA_FALSE;
+    }
+
+    canvas->pixels = (uint32_t *)data;
+    for (j = 0; j < h; j++)
+        memset((unsigned char *)canvas->pixels + j * canvas->stride, 0, w * sizeof(uint32_t));
+
+    return EINA_TRUE;
+}
+
+/* ends the drawing, the surface being given to the renderer */
+void
+echart_canvas_end(Echart_Canvas *canvas)
+{
+    enesim_renderer_image_position_set(canvas->renderer, canvas->x, canvas->y);
+    enesim_renderer_image_size_set(canvas->renderer, canvas->w, canvas->h);
+    if (!canvas->pixels)
+        return;
+
+    canvas->pixels = NULL;
+    enesim_surface_unlock(canvas->surface);
+
+    /* the renderer takes a reference */
+    enesim_renderer_image_source_surface_set(canvas->renderer, enesim_surface_ref(canvas->surface));
+}
+
+/*
+ * color, premultiplied, with a coverage a in [0, 256] over len pixels of
+ * the row y from x, in the coordinates of the surface. Clipped.
+ */
+void
+echart_canvas_span_blend(Echart_Canvas *canvas, int x, int y, int len, uint32_t a, Enesim_Color color)
+{
+    uint32_t *dst;
+    uint32_t *end;
+    uint32_t src;
+    uint32_t ia;
+
+    if (!canvas->pixels || (y < 0) || (y >= canvas->h) || !a)
+        return;
+
+    if (x < 0)
+    {
+        len += x;
+        x = 0;
+    }
+    if (x + len > canvas->w)
+        len = canvas->w - x;
+    if (len <= 0)
+        return;
+
+    src = (a >= 256) ? color : ECHART_ARGB_MUL_256(a, color);
+    dst = (uint32_t *)((unsigned char *)canvas->pixels + y * canvas->stride) + x;
+    end = dst + len;
+
+    /* opaque spans are just filled */
+    if ((src >> 24) == 0xff)
+    {
+        while (dst < end)
+            *dst++ = src;
+        return;
+    }
+
+    ia = 256 - (src >> 24);
+    while (dst < end)
+    {
+        *dst = src + ECHART_ARGB_MUL_256(ia, *dst);
+        dst++;
+    }
+}
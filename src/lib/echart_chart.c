@@ -21,6 +21,7 @@
 #endif
 
 #include <Enesim.h>
+#include <math.h>
 
 #include "Echart.h"
 #include "echart_private.h"
@@ -45,17 +46,16 @@ struct _Echart_Chart
         int y_nbr;
         Enesim_Argb color;
     } grid, sub_grid;
+    struct
+    {
+        double xmin;
+        double xmax;
+        Eina_Bool set;
+    } viewport;
+    Echart_Generation generation;
 };
 
-/**
- * @endcond
- */
-
-/*============================================================================*
- *                                 Global                                     *
- *============================================================================*/
-
-Echart_Colors echart_chart_default_colors[20] =
+static const Echart_Colors _echart_chart_default_colors[20] =
 {
     { 0xff3366CC, 0xffc2d1f0 },
     { 0xffDC3912, 0xfff5c4b8 },
@@ -79,6 +79,61 @@ Echart_Colors echart_chart_default_colors[20] =
     { 0xff3B3EAC, 0xffc4c5e6 }
 };
 
+static Enesim_Argb
+_echart_chart_color_from_hsv(double h, double s, double v)
+{
+    double c;
+    double x;
+    double m;
+    double r;
+    double g;
+    double b;
+
+    c = v * s;
+    x = c * (1.0 - fabs(fmod(h / 60.0, 2.0) - 1.0));
+    m = v - c;
+    if (h < 60.0)       { r = c; g = x; b = 0; }
+    else if (h < 120.0) { r = x; g = c; b = 0; }
+    else if (h < 180.0) { r = 0; g = c; b = x; }
+    else if (h < 240.0) { r = 0; g = x; b = c; }
+    else if (h < 300.0) { r = x; g = 0; b = c; }
+    else                { r = c; g = 0; b = x; }
+
+    return 0xff000000 |
+        ((uint32_t)((r + m) * 255.0 + 0.5) << 16) |
+        ((uint32_t)((g + m) * 255.0 + 0.5) << 8) |
+        (uint32_t)((b + m) * 255.0 + 0.5);
+}
+
+/**
+ * @endcond
+ */
+
+/*============================================================================*
+ *                                 Global                                     *
+ *============================================================================*/
+
+
+/*
+ * the fixed palette is used for the first items, the next ones have their
+ * hue rotated by the golden angle, which keeps consecutive colors apart
+ */
+Echart_Colors
+echart_chart_default_colors_get(unsigned int idx)
+{
+    Echart_Colors colors;
+    double h;
+
+    if (idx < sizeof(_echart_chart_default_colors) / sizeof(_echart_chart_default_colors[0]))
+        return _echart_chart_default_colors[idx];
+
+    h = fmod(idx * 137.507764, 360.0);
+    colors.line = _echart_chart_color_from_hsv(h, 0.75, 0.80);
+    colors.area = _echart_chart_color_from_hsv(h, 0.25, 0.95);
+
+    return colors;
+}
+
 /*============================================================================*
  *                                   API                                      *
  *============================================================================*/
@@ -101,6 +156,7 @@ echart_chart_new(void)
     chart->sub_grid.x_nbr = 0;
     chart->sub_grid.y_nbr = 0;
     chart->sub_grid.color = 0xffeeeeee;
+    echart_generation_init(&chart->generation);
 
     return chart;
 }
@@ -119,11 +175,15 @@ echart_chart_free(Echart_Chart *chart)
 EAPI void
 echart_chart_size_set(Echart_Chart *chart, int width, int height)
 {
-    if (!chart || (width <= 0) || (height >= 0))
+    if (!chart || (width <= 0) || (height <= 0))
+        return;
+
+    if ((chart->width == width) && (chart->height == height))
         return;
 
     chart->width = width;
     chart->height = height;
+    echart_generation_bump(&chart->generation, ECHART_CHANGE_SIZE);
 }
 
 EAPI void
@@ -147,6 +207,7 @@ echart_chart_background_color_set(Echart_Chart *chart, uint8_t a, uint8_t r, uin
         return;
 
     enesim_argb_components_from(&chart->background_color, a, r, g, b);
+    echart_generation_bump(&chart->generation, ECHART_CHANGE_STYLE);
 }
 
 EAPI Enesim_Argb
@@ -164,8 +225,12 @@ echart_chart_grid_nbr_set(Echart_Chart *chart, int grid_x_nbr, int grid_y_nbr)
     if (!chart || (grid_x_nbr < 0) || (grid_y_nbr < 0))
         return;
 
+    if ((chart->grid.x_nbr == grid_x_nbr) && (chart->grid.y_nbr == grid_y_nbr))
+        return;
+
     chart->grid.x_nbr = grid_x_nbr;
     chart->grid.y_nbr = grid_y_nbr;
+    echart_generation_bump(&chart->generation, ECHART_CHANGE_STYLE);
 }
 
 EAPI void
@@ -189,6 +254,7 @@ echart_chart_grid_color_set(Echart_Chart *chart, uint8_t a, uint8_t r, uint8_t g
         return;
 
     enesim_argb_components_from(&chart->grid.color, a, r, g, b);
+    echart_generation_bump(&chart->generation, ECHART_CHANGE_STYLE);
 }
 
 EAPI Enesim_Argb
@@ -206,8 +272,12 @@ echart_chart_sub_grid_nbr_set(Echart_Chart *chart, int grid_x_nbr, int grid_y_nb
     if (!chart || (grid_x_nbr < 0) || (grid_y_nbr < 0))
         return;
 
+    if ((chart->sub_grid.x_nbr == grid_x_nbr) && (chart->sub_grid.y_nbr == grid_y_nbr))
+        return;
+
     chart->sub_grid.x_nbr = grid_x_nbr;
     chart->sub_grid.y_nbr = grid_y_nbr;
+    echart_generation_bump(&chart->generation, ECHART_CHANGE_STYLE);
 }
 
 EAPI void
@@ -231,6 +301,7 @@ echart_chart_sub_grid_color_set(Echart_Chart *chart, uint8_t a, uint8_t r, uint8
         return;
 
     enesim_argb_components_from(&chart->sub_grid.color, a, r, g, b);
+    echart_generation_bump(&chart->generation, ECHART_CHANGE_STYLE);
 }
 
 EAPI Enesim_Argb
@@ -249,6 +320,7 @@ echart_chart_data_set(Echart_Chart *chart, Echart_Data *data)
         return;
 
     chart->data = data;
+    echart_generation_bump(&chart->generation, ECHART_CHANGE_DATA);
 }
 
 EAPI const Echart_Data *
@@ -259,3 +331,72 @@ echart_chart_data_get(const Echart_Chart *chart)
 
     return chart->data;
 }
+
+/*
+ * Shows the values of the absciss in [xmin, xmax] only. The interval of
+ * the values of each series in the viewport is computed from the level of
+ * detail of its item when it has one, otherwise by reading all of them.
+ */
+EAPI void
+echart_chart_viewport_set(Echart_Chart *chart, double xmin, double xmax)
+{
+    if (!chart)
+        return;
+
+    /*
+     * an empty interval removes the viewport. The chart is not changed, so
+     * not redrawn, when the viewport is the same.
+     */
+    if (!(xmin < xmax))
+    {
+        if (!chart->viewport.set)
+            return;
+    }
+    else if (chart->viewport.set &&
+             (chart->viewport.xmin == xmin) && (chart->viewport.xmax == xmax))
+        return;
+
+    chart->viewport.xmin = xmin;
+    chart->viewport.xmax = xmax;
+    chart->viewport.set = (xmin < xmax);
+    echart_generation_bump(&chart->generation, ECHART_CHANGE_VIEWPORT);
+}
+
+EAPI Eina_Bool
+echart_chart_viewport_get(const Echart_Chart *chart, double *xmin, double *xmax)
+{
+    if (!chart || !chart->viewport.set)
+    {
+        if (xmin) *xmin = 0.0;
+        if (xmax) *xmax = 0.0;
+        return EINA_FALSE;
+    }
+
+    if (xmin) *xmin = chart->viewport.xmin;
+    if (xmax) *xmax = chart->viewport.xmax;
+
+    return EINA_TRUE;
+}
+
+EAPI unsigned int
+echart_chart_generation_get(const Echart_Chart *chart)
+{
+    if (!chart)
+        return 0;
+
+    return chart->generation.current;
+}
+
+/*
+ * The changes of the chart since the given generation, 0 returning all of
+ * them. The changes of the data and of its items are tracked by the data
+ * and the items themselves.
+ */
+EAPI Echart_Change
+echart_chart_changes_get(const Echart_Chart *chart, unsigned int generation)
+{
+    if (!chart)
+        return ECHART_CHANGE_NONE;
+
+    return echart_generation_changes_get(&chart->generation, generation);
+}
@@ -0,0 +1,715 @@
+/* Echart - Chart rendering library
+ * Copyright (C) 2013 Vincent Torri
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <limits.h>
+
+#include <Enesim.h>
+
+#include "Echart.h"
+#include "echart_private.h"
+
+/*============================================================================*
+ *                                  Local                                     *
+ *============================================================================*/
+
+/**
+ * @cond LOCAL
+ */
+
+/*
+ * The values are encoded in independent blocks of ECHART_CODEC_BLOCK_SIZE
+ * values, so that a range is decoded from the start of its first block
+ * only. The first value of a block is stored as is, the next ones as bit
+ * strings:
+ *
+ * - integers, with the delta of delta of consecutive values, zigzag encoded:
+ *   '0' for 0, then '10', '110', '1110', '11110' and '11111' followed by 7,
+ *   9, 12, 32 and 64 bits. Regular timestamps take 1 bit per value.
+ * - floating point values, with the xor of consecutive values: '0' when
+ *   equal, '10' followed by the meaningful bits when they fit in the
+ *   previous window, '11' followed by 6 bits of leading zeros, 6 bits of
+ *   length minus 1 and the meaningful bits otherwise.
+ *
+ * The bits are stored from the least significant one of each word.
+ */
+#define ECHART_CODEC_BLOCK_SHIFT 10
+#define ECHART_CODEC_BLOCK_SIZE (1U << ECHART_CODEC_BLOCK_SHIFT)
+
+/* no xor window yet */
+#define ECHART_CODEC_LEAD_NONE 64
+
+typedef struct _Echart_Codec_Block Echart_Codec_Block;
+typedef struct _Echart_Codec_Reader Echart_Codec_Reader;
+typedef struct _Echart_Codec_Cursor Echart_Codec_Cursor;
+
+struct _Echart_Codec_Block
+{
+    uint64_t *words;
+    unsigned int words_alloc;
+    uint64_t bits;
+    unsigned int count;
+    /* raw bits of the first value: an int64_t or a double */
+    uint64_t first;
+    double vmin;
+    double vmax;
+};
+
+struct _Echart_Codec_Reader
+{
+    const uint64_t *words;
+    uint64_t pos;
+};
+
+struct _Echart_Codec_Cursor
+{
+    Echart_Codec_Reader r;
+    uint64_t raw;
+    uint64_t delta;
+    unsigned int lead;
+    unsigned int trail;
+    /* block of the cursor and index in it of the next value */
+    unsigned int block;
+    unsigned int idx;
+};
+
+struct _Echart_Codec
+{
+    Echart_Value_Type type;
+    Echart_Codec_Block *blocks;
+    unsigned int blocks_count;
+    unsigned int blocks_alloc;
+    unsigned int count;
+    /* encoder state after the last value */
+    struct
+    {
+        uint64_t prev;
+        uint64_t delta;
+        unsigned int lead;
+        unsigned int trail;
+    } state;
+    double vmin;
+    double vmax;
+};
+
+static inline unsigned int
+_echart_codec_clz(uint64_t v)
+{
+#ifdef __GNUC__
+    return __builtin_clzll(v);
+#else
+    unsigned int n;
+
+    n = 0;
+    while (!(v & ((uint64_t)1 << 63)))
+    {
+        v <<= 1;
+        n++;
+    }
+
+    return n;
+#endif
+}
+
+static inline unsigned int
+_echart_codec_ctz(uint64_t v)
+{
+#ifdef __GNUC__
+    return __builtin_ctzll(v);
+#else
+    unsigned int n;
+
+    n = 0;
+    while (!(v & 1))
+    {
+        v >>= 1;
+        n++;
+    }
+
+    return n;
+#endif
+}
+
+static inline Eina_Bool
+_echart_codec_is_integer(Echart_Value_Type type)
+{
+    return (type == ECHART_VALUE_TYPE_INT32) || (type == ECHART_VALUE_TYPE_INT64);
+}
+
+/* the raw bits of value, converted to the type of the codec */
+static inline uint64_t
+_echart_codec_raw(Echart_Value_Type type, double value)
+{
+    union { double d; uint64_t u; } v;
+
+    switch (type)
+    {
+        case ECHART_VALUE_TYPE_INT32:
+            return (uint64_t)(int64_t)echart_value_int32_get(value);
+        case ECHART_VALUE_TYPE_INT64:
+            return (uint64_t)echart_value_int64_get(value);
+        case ECHART_VALUE_TYPE_FLOAT:
+            v.d = (float)value;
+            return v.u;
+        default:
+            v.d = value;
+            return v.u;
+    }
+}
+
+static inline double
+_echart_codec_value(Echart_Value_Type type, uint64_t raw)
+{
+    union { double d; uint64_t u; } v;
+
+    if (_echart_codec_is_integer(type))
+        return (double)(int64_t)raw;
+
+    v.u = raw;
+    return v.d;
+}
+
+static Eina_Bool
+_echart_codec_bits_write(Echart_Codec_Block *block, uint64_t v, unsigned int n)
+{
+    unsigned int w;
+    unsigned int off;
+
+    w = (unsigned int)((block->bits + n + 63) >> 6);
+    if (w > block->words_alloc)
+    {
+        uint64_t *words;
+        unsigned int alloc;
+
+        alloc = block->words_alloc ? block->words_alloc : 16;
+        while (alloc < w)
+            alloc *= 2;
+        words = (uint64_t *)realloc(block->words, alloc * sizeof(uint64_t));
+        if (!words)
+            return EINA_FALSE;
+        memset(words + block->words_alloc, 0, (alloc - block->words_alloc) * sizeof(uint64_t));
+        block->words = words;
+        block->words_alloc = alloc;
+    }
+
+    if (n < 64)
+        v &= ((uint64_t)1 << n) - 1;
+    w = (unsigned int)(block->bits >> 6);
+    off = (unsigned int)(block->bits & 63);
+    block->words[w] |= v << off;
+    if (off + n > 64)
+        block->words[w + 1] |= v >> (64 - off);
+    block->bits += n;
+
+    return EINA_TRUE;
+}
+
+static inline uint64_t
+_echart_codec_bits_read(Echart_Codec_Reader *r, unsigned int n)
+{
+    uint64_t v;
+    unsigned int w;
+    unsigned int off;
+
+    w = (unsigned int)(r->pos >> 6);
+    off = (unsigned int)(r->pos & 63);
+    v = r->words[w] >> off;
+    if (off + n > 64)
+        v |= r->words[w + 1] << (64 - off);
+    if (n < 64)
+        v &= ((uint64_t)1 << n) - 1;
+    r->pos += n;
+
+    return v;
+}
+
+/* count of consecutive 1 bits, up to max, the terminating 0 is consumed */
+static inline unsigned int
+_echart_codec_ones_read(Echart_Codec_Reader *r, unsigned int max)
+{
+    unsigned int k;
+
+    for (k = 0; k < max; k++)
+    {
+        if (!_echart_codec_bits_read(r, 1))
+            break;
+    }
+
+    return k;
+}
+
+static Eina_Bool
+_echart_codec_integer_write(Echart_Codec *codec, Echart_Codec_Block *block, uint64_t raw)
+{
+    static const unsigned int sizes[] = { 7, 9, 12, 32 };
+    uint64_t delta;
+    uint64_t zz;
+    int64_t dod;
+    unsigned int k;
+
+    /* wrapping arithmetic, the values can be any int64_t */
+    delta = raw - codec->state.prev;
+    dod = (int64_t)(delta - codec->state.delta);
+    codec->state.prev = raw;
+    codec->state.delta = delta;
+
+    if (!dod)
+        return _echart_codec_bits_write(block, 0, 1);
+
+    zz = ((uint64_t)dod << 1) ^ (uint64_t)(dod >> 63);
+    for (k = 0; k < 4; k++)
+    {
+        if (zz < ((uint64_t)1 << sizes[k]))
+        {
+            /* k + 1 bits set followed by a 0 */
+            return _echart_codec_bits_write(block, ((uint64_t)1 << (k + 1)) - 1, k + 2) &&
+                   _echart_codec_bits_write(block, zz, sizes[k]);
+        }
+    }
+
+    return _echart_codec_bits_write(block, 0x1f, 5) &&
+           _echart_codec_bits_write(block, zz, 64);
+}
+
+static Eina_Bool
+_echart_codec_float_write(Echart_Codec *codec, Echart_Codec_Block *block, uint64_t raw)
+{
+    uint64_t x;
+    unsigned int lead;
+    unsigned int trail;
+    unsigned int len;
+
+    x = raw ^ codec->state.prev;
+    codec->state.prev = raw;
+    if (!x)
+        return _echart_codec_bits_write(block, 0, 1);
+
+    lead = _echart_codec_clz(x);
+    trail = _echart_codec_ctz(x);
+    if ((codec->state.lead != ECHART_CODEC_LEAD_NONE) &&
+        (lead >= codec->state.lead) && (trail >= codec->state.trail))
+    {
+        len = 64 - codec->state.lead - codec->state.trail;
+        return _echart_codec_bits_write(block, 0x1, 2) &&
+               _echart_codec_bits_write(block, x >> codec->state.trail, len);
+    }
+
+    len = 64 - lead - trail;
+    codec->state.lead = lead;
+    codec->state.trail = trail;
+    return _echart_codec_bits_write(block, 0x3, 2) &&
+           _echart_codec_bits_write(block, lead, 6) &&
+           _echart_codec_bits_write(block, len - 1, 6) &&
+           _echart_codec_bits_write(block, x >> trail, len);
+}
+
+/*
+ * Decoding state of a block, owned by the caller: the codec itself is only
+ * read, so that it can be decoded by several threads at once.
+ */
+static inline void
+_echart_codec_cursor_init(Echart_Codec_Cursor *cur, const Echart_Codec_Block *block)
+{
+    cur->r.words = block->words;
+    cur->r.pos = 0;
+    cur->raw = block->first;
+    cur->delta = 0;
+    cur->lead = ECHART_CODEC_LEAD_NONE;
+    cur->trail = 0;
+    cur->idx = 0;
+}
+
+/* the value of index cur->idx in the block, the cursor is then moved to the next one */
+static inline double
+_echart_codec_cursor_next(const Echart_Codec *codec, Echart_Codec_Cursor *cur)
+{
+    static const unsigned int sizes[] = { 7, 9, 12, 32, 64 };
+
+    if (cur->idx)
+    {
+        if (_echart_codec_is_integer(codec->type))
+        {
+            unsigned int k;
+
+            k = _echart_codec_ones_read(&cur->r, 5);
+            if (k)
+            {
+                uint64_t zz;
+
+                zz = _echart_codec_bits_read(&cur->r, sizes[k - 1]);
+                cur->delta += (zz >> 1) ^ (~(zz & 1) + 1);
+            }
+            cur->raw += cur->delta;
+        }
+        else if (_echart_codec_bits_read(&cur->r, 1))
+        {
+            unsigned int len;
+
+            if (_echart_codec_bits_read(&cur->r, 1))
+            {
+                cur->lead = (unsigned int)_echart_codec_bits_read(&cur->r, 6);
+                len = (unsigned int)_echart_codec_bits_read(&cur->r, 6) + 1;
+                cur->trail = 64 - cur->lead - len;
+            }
+            else
+                len = 64 - cur->lead - cur->trail;
+            cur->raw ^= _echart_codec_bits_read(&cur->r, len) << cur->trail;
+        }
+    }
+    cur->idx++;
+
+    return _echart_codec_value(codec->type, cur->raw);
+}
+
+/* moves the cursor to the value of index idx of the codec, from the start of its block if needed */
+static inline void
+_echart_codec_cursor_seek(const Echart_Codec *codec, Echart_Codec_Cursor *cur, unsigned int idx)
+{
+    unsigned int b;
+    unsigned int i;
+
+    b = idx >> ECHART_CODEC_BLOCK_SHIFT;
+    i = idx & (ECHART_CODEC_BLOCK_SIZE - 1);
+    if ((cur->block != b) || (cur->idx > i))
+    {
+        _echart_codec_cursor_init(cur, codec->blocks + b);
+        cur->block = b;
+    }
+
+    while (cur->idx < i)
+        _echart_codec_cursor_next(codec, cur);
+}
+
+/*
+ * decodes the values of index in [0, skip + count) of the block, storing the
+ * ones of index greater than or equal to skip in res
+ */
+static void
+_echart_codec_block_decode(const Echart_Codec *codec, const Echart_Codec_Block *block,
+                           unsigned int skip, unsigned int count, double *res)
+{
+    Echart_Codec_Cursor cur;
+    unsigned int i;
+
+    _echart_codec_cursor_init(&cur, block);
+    for (i = 0; i < skip; i++)
+        _echart_codec_cursor_next(codec, &cur);
+    for (i = 0; i < count; i++)
+        res[i] = _echart_codec_cursor_next(codec, &cur);
+}
+
+/**
+ * @endcond
+ */
+
+/*============================================================================*
+ *                                 Global                                     *
+ *============================================================================*/
+
+Echart_Codec *
+echart_codec_new(Echart_Value_Type type)
+{
+    Echart_Codec *codec;
+
+    codec = (Echart_Codec *)calloc(1, sizeof(Echart_Codec));
+    if (!codec)
+        return NULL;
+
+    codec->type = type;
+
+    return codec;
+}
+
+void
+echart_codec_free(Echart_Codec *codec)
+{
+    unsigned int i;
+
+    if (!codec)
+        return;
+
+    for (i = 0; i < codec->blocks_count; i++)
+        free(codec->blocks[i].words);
+    free(codec->blocks);
+    free(codec);
+}
+
+unsigned int
+echart_codec_count(const Echart_Codec *codec)
+{
+    return codec->count;
+}
+
+/* the memory used by the encoded values */
+size_t
+echart_codec_size(const Echart_Codec *codec)
+{
+    size_t size;
+    unsigned int i;
+
+    size = codec->blocks_alloc * sizeof(Echart_Codec_Block);
+    for (i = 0; i < codec->blocks_count; i++)
+        size += codec->blocks[i].words_alloc * sizeof(uint64_t);
+
+    return size;
+}
+
+Eina_Bool
+echart_codec_append(Echart_Codec *codec, const double *values, unsigned int count)
+{
+    unsigned int i;
+
+    for (i = 0; i < count; i++)
+    {
+        Echart_Codec_Block *block;
+        uint64_t raw;
+        double v;
+
+        raw = _echart_codec_raw(codec->type, values[i]);
+        v = _echart_codec_value(codec->type, raw);
+
+        if (!(codec->count & (ECHART_CODEC_BLOCK_SIZE - 1)))
+        {
+            if (codec->blocks_count == codec->blocks_alloc)
+            {
+                Echart_Codec_Block *blocks;
+                unsigned int alloc;
+
+                alloc = codec->blocks_alloc ? 2 * codec->blocks_alloc : 16;
+                blocks = (Echart_Codec_Block *)realloc(codec->blocks, alloc * sizeof(Echart_Codec_Block));
+                if (!blocks)
+                    return EINA_FALSE;
+                codec->blocks = blocks;
+                codec->blocks_alloc = alloc;
+            }
+
+            /* the previous block is complete, its words are trimmed */
+            if (codec->blocks_count)
+            {
+                uint64_t *words;
+                unsigned int w;
+
+                block = codec->blocks + codec->blocks_count - 1;
+                w = (unsigned int)((block->bits + 63) >> 6);
+                words = (uint64_t *)realloc(block->words, (w ? w : 1) * sizeof(uint64_t));
+                if (words)
+                {
+                    block->words = words;
+                    block->words_alloc = w ? w : 1;
+                }
+            }
+
+            block = codec->blocks + codec->blocks_count;
+            memset(block, 0, sizeof(Echart_Codec_Block));
+            block->first = raw;
+            block->vmin = v;
+            block->vmax = v;
+            codec->blocks_count++;
+
+            codec->state.prev = raw;
+            codec->state.delta = 0;
+            codec->state.lead = ECHART_CODEC_LEAD_NONE;
+            codec->state.trail = 0;
+        }
+        else
+        {
+            Eina_Bool ret;
+
+            block = codec->blocks + codec->blocks_count - 1;
+            if (_echart_codec_is_integer(codec->type))
+                ret = _echart_codec_integer_write(codec, block, raw);
+            else
+                ret = _echart_codec_float_write(codec, block, raw);
+            if (!ret)
+                return EINA_FALSE;
+
+            if (v < block->vmin) block->vmin = v;
+            if (v > block->vmax) block->vmax = v;
+        }
+
+        block->count++;
+        if (!codec->count || (v < codec->vmin)) codec->vmin = v;
+        if (!codec->count || (v > codec->vmax)) codec->vmax = v;
+        codec->count++;
+    }
+
+    return EINA_TRUE;
+}
+
+/* decodes the values of index in [start, start + count) in res */
+void
+echart_codec_decode(const Echart_Codec *codec, unsigned int start, unsigned int count, double *res)
+{
+    while (count)
+    {
+        unsigned int b;
+        unsigned int skip;
+        unsigned int n;
+
+        b = start >> ECHART_CODEC_BLOCK_SHIFT;
+        skip = start & (ECHART_CODEC_BLOCK_SIZE - 1);
+        n = codec->blocks[b].count - skip;
+        if (n > count)
+            n = count;
+
+        _echart_codec_block_decode(codec, codec->blocks + b, skip, n, res);
+        res += n;
+        start += n;
+        count -= n;
+    }
+}
+
+/* random access, the block of idx is decoded up to it */
+double
+echart_codec_value_get(const Echart_Codec *codec, unsigned int idx)
+{
+    Echart_Codec_Cursor cur;
+
+    cur.block = UINT_MAX;
+    _echart_codec_cursor_seek(codec, &cur, idx);
+    return _echart_codec_cursor_next(codec, &cur);
+}
+
+/*
+ * res[k] = value(start + indices[k]). The increasing indices of a block are
+ * read in a single pass over it.
+ */
+void
+echart_codec_gather(const Echart_Codec *codec, unsigned int start,
+                    const unsigned int *indices, unsigned int count, double *res)
+{
+    Echart_Codec_Cursor cur;
+    unsigned int k;
+
+    cur.block = UINT_MAX;
+    for (k = 0; k < count; k++)
+    {
+        _echart_codec_cursor_seek(codec, &cur, start + indices[k]);
+        res[k] = _echart_codec_cursor_next(codec, &cur);
+    }
+}
+
+/*
+ * index of the first value greater than or equal to x, or greater than x
+ * if strict is set, the values being sorted in increasing order. The block
+ * is found with the bounds of the blocks, then only this block is decoded.
+ */
+unsigned int
+echart_codec_lower_bound(const Echart_Codec *codec, double x, Eina_Bool strict)
+{
+    const Echart_Codec_Block *block;
+    Echart_Codec_Cursor cur;
+    unsigned int lo;
+    unsigned int hi;
+
+    /* first block whose last value, its maximum, is not before x */
+    lo = 0;
+    hi = codec->blocks_count;
+    while (lo < hi)
+    {
+        unsigned int mid;
+
+        mid = lo + (hi - lo) / 2;
+        if (strict ? (codec->blocks[mid].vmax <= x) : (codec->blocks[mid].vmax < x))
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+
+    if (lo == codec->blocks_count)
+        return codec->count;
+
+    block = codec->blocks + lo;
+    _echart_codec_cursor_init(&cur, block);
+    while (cur.idx < block->count)
+    {
+        double v;
+
+        v = _echart_codec_cursor_next(codec, &cur);
+        if (strict ? (v > x) : (v >= x))
+            return (lo << ECHART_CODEC_BLOCK_SHIFT) + cur.idx - 1;
+    }
+
+    return (lo << ECHART_CODEC_BLOCK_SHIFT) + block->count;
+}
+
+/*
+ * the interval of the values of index in [start, end), with start < end.
+ * Only the partial blocks at both ends of the range are decoded.
+ */
+void
+echart_codec_interval_get(const Echart_Codec *codec, unsigned int start, unsigned int end, double *vmin, double *vmax)
+{
+    Eina_Bool first;
+
+    if ((start == 0) && (end == codec->count))
+    {
+        *vmin = codec->vmin;
+        *vmax = codec->vmax;
+        return;
+    }
+
+    first = EINA_TRUE;
+    while (start < end)
+    {
+        const Echart_Codec_Block *block;
+        unsigned int b;
+        unsigned int skip;
+        unsigned int n;
+        double min;
+        double max;
+
+        b = start >> ECHART_CODEC_BLOCK_SHIFT;
+        block = codec->blocks + b;
+        skip = start & (ECHART_CODEC_BLOCK_SIZE - 1);
+        n = block->count - skip;
+        if (n > end - start)
+            n = end - start;
+
+        if (n == block->count)
+        {
+            min = block->vmin;
+            max = block->vmax;
+        }
+        else
+        {
+            Echart_Codec_Cursor cur;
+            unsigned int i;
+
+            cur.block = UINT_MAX;
+            _echart_codec_cursor_seek(codec, &cur, start);
+            min = max = _echart_codec_cursor_next(codec, &cur);
+            for (i = 1; i < n; i++)
+            {
+                double v;
+
+                v = _echart_codec_cursor_next(codec, &cur);
+                if (v < min) min = v;
+                if (v > max) max = v;
+            }
+        }
+
+        if (first || (min < *vmin)) *vmin = min;
+        if (first || (max > *vmax)) *vmax = max;
+        first = EINA_FALSE;
+        start += n;
+    }
+}
@@ -76,23 +76,53 @@ do \
 struct _Echart_Column
 {
     const Echart_Chart *chart;
+    /* the last renderer, kept while the chart and its data do not change */
+    Enesim_Renderer *renderer;
+    const Echart_Data *data;
+    unsigned int chart_generation;
+    unsigned int data_generation;
+    unsigned int *generations;
+    unsigned int generations_count;
 };
 
-static Enesim_Renderer *
-_echart_text_renderer_from_double(Enesim_Text_Font *f, double d)
+/* the label of d, truncated as an integer */
+static void
+_echart_label_from_double(char *buf, size_t size, double d)
 {
-    char buf[256];
-    Enesim_Renderer *r;
+    echart_label_format(buf, size, d < 0 ? ceil(d) : floor(d), 0);
+}
 
-    snprintf(buf, sizeof(buf), "%d", (int)d);
-    buf[sizeof(buf) - 1] = '\0';
+/*
+ * the number of labels to skip so that they do not overlap, label_area
+ * being the space between two of them. The widest label is the one of the
+ * bound with the most digits
+ */
+static int
+_echart_labels_stride_get(const Echart_Labels *labels, const Echart_Data_Item *item,
+                          int font_size, double label_area, Eina_Bool horizontal)
+{
+    char buf[64];
+    double vmin;
+    double vmax;
+    int size;
 
-    r = enesim_renderer_text_span_new();
-    enesim_renderer_color_set(r, 0xff000000);
-    enesim_renderer_text_span_text_set(r, buf);
-    enesim_renderer_text_span_font_set(r, f);
+    if (label_area <= 0)
+        return 1;
 
-    return r;
+    if (horizontal)
+    {
+        echart_data_item_interval_get(item, &vmin, &vmax);
+        _echart_label_from_double(buf, sizeof(buf), vmin);
+        size = echart_labels_width_get(labels, buf);
+        _echart_label_from_double(buf, sizeof(buf), vmax);
+        if (size < echart_labels_width_get(labels, buf))
+            size = echart_labels_width_get(labels, buf);
+    }
+    else
+        size = echart_labels_height_get(labels);
+
+    /* a margin of half the font size between two labels */
+    return (int)ceil((size + font_size / 2) / label_area);
 }
 
 /* draw the main layout of a graph
@@ -111,7 +141,7 @@ _echart_grid_layout_renderer_get(const Echart_Chart *chart,
     Enesim_Renderer *c, *r;
     Enesim_Renderer_Compound_Layer *l;
     Enesim_Text_Font *f;
-    Enesim_Text_Engine *e;
+    Echart_Labels *labels;
     const char *label;
     double label_space;
     int font_size = 16;
@@ -133,10 +163,8 @@ _echart_grid_layout_renderer_get(const Echart_Chart *chart,
     enesim_renderer_shape_draw_mode_set(r, ENESIM_RENDERER_SHAPE_DRAW_MODE_FILL);
     ECHART_RENDERER_LAYER_ADD(c, r, ENESIM_ROP_FILL);
 
-    /* the common text properties */
-    e = enesim_text_engine_default_get();
-    f = enesim_text_font_new_description_from(e, "arial", font_size);
-    enesim_text_engine_unref(e);
+    /* the common text properties, the font being shared by all the drawers */
+    f = echart_font_get("arial", font_size);
 
     label_space = hypot(area->h, area->w) * 0.08;
     /* title */
@@ -148,7 +176,8 @@ _echart_grid_layout_renderer_get(const Echart_Chart *chart,
         r = enesim_renderer_text_span_new();
         enesim_renderer_color_set(r, 0xff000000);
         enesim_renderer_text_span_text_set(r, echart_data_title_get(data));
-        enesim_renderer_text_span_font_set(r, f);
+        if (f)
+            enesim_renderer_text_span_font_set(r, enesim_text_font_ref(f));
 
         enesim_renderer_shape_destination_geometry_get(r, &geom);
         enesim_renderer_origin_set(r, (w - geom.w) / 2.0, label_space / 2.0);
@@ -167,7 +196,7 @@ _echart_grid_layout_renderer_get(const Echart_Chart *chart,
             double label_area;
             int n_data;
 
-            n_data = eina_list_count(echart_data_item_values_get(x_labels));
+            n_data = echart_data_item_values_count(x_labels);
             label_area = area->w / (n_data - 1);
             area->x += label_area / 2.0;
             area->w -= label_area;
@@ -184,12 +213,10 @@ _echart_grid_layout_renderer_get(const Echart_Chart *chart,
         }
     }
 
-    /* draw the labels */
-    if (x_labels)
+    /* draw the labels, all of them with a single renderer */
+    labels = echart_labels_new("arial", font_size);
+    if (labels && x_labels)
     {
-        const Eina_List *labels = echart_data_item_values_get(x_labels);
-        const Eina_List *ll;
-        double *d;
         /* we start at the low corner of the char area and add a margin
          * of size of the font_size to avoid a collision with the y_labels
          */
@@ -197,8 +224,10 @@ _echart_grid_layout_renderer_get(const Echart_Chart *chart,
         double x;
         double label_area;
         int n_data;
+        int stride;
+        int i;
 
-        n_data = eina_list_count(echart_data_item_values_get(x_labels));
+        n_data = echart_data_item_values_count(x_labels);
         if (inset)
         {
             label_area = area->w / (n_data + 1);
@@ -210,31 +239,29 @@ _echart_grid_layout_renderer_get(const Echart_Chart *chart,
             x = area->x;
         }
 
-        EINA_LIST_FOREACH(labels, ll, d)
+        /* only one label every stride ones when they do not all fit */
+        stride = _echart_labels_stride_get(labels, x_labels, font_size, label_area, EINA_TRUE);
+        for (i = 0; i < n_data; i += stride)
         {
-            Enesim_Rectangle geom;
+            char buf[64];
 
-            r = _echart_text_renderer_from_double(f, *d);
-            enesim_renderer_shape_destination_geometry_get(r, &geom);
+            _echart_label_from_double(buf, sizeof(buf), echart_data_item_value_get(x_labels, i));
             /* center the text */
-            enesim_renderer_origin_set(r, x - (geom.w / 2), y);
-            ECHART_RENDERER_LAYER_ADD(c, r, ENESIM_ROP_BLEND);
-            x += label_area;
+            echart_labels_add(labels, buf, x - echart_labels_width_get(labels, buf) / 2, y);
+            x += label_area * stride;
         }
-        
     }
 
-    if (y_labels)
+    if (labels && y_labels)
     {
-        const Eina_List *labels = echart_data_item_values_get(y_labels);
-        const Eina_List *ll;
-        double *d;
         double y;
         double x = area->x - label_space;
         double label_area;
         int n_data;
+        int stride;
+        int i;
 
-        n_data = eina_list_count(echart_data_item_values_get(y_labels));
+        n_data = echart_data_item_values_count(y_labels);
         if (inset)
         {
             label_area = area->h / (n_data + 1);
@@ -246,18 +273,25 @@ _echart_grid_layout_renderer_get(const Echart_Chart *chart,
             y = area->y - (font_size / 2);
         }
 
-        EINA_LIST_FOREACH(labels, ll, d)
+        stride = _echart_labels_stride_get(labels, y_labels, font_size, label_area, EINA_FALSE);
+        for (i = 0; i < n_data; i += stride)
         {
-            Enesim_Rectangle geom;
+            char buf[64];
 
-            r = _echart_text_renderer_from_double(f, *d);
-            enesim_renderer_shape_destination_geometry_get(r, &geom);
-            /* center the text */
-            enesim_renderer_origin_set(r, x, y);
-            ECHART_RENDERER_LAYER_ADD(c, r, ENESIM_ROP_BLEND);
+            _echart_label_from_double(buf, sizeof(buf), echart_data_item_value_get(y_labels, i));
+            echart_labels_add(labels, buf, x, y);
+            y += label_area * stride;
+        }
+    }
 
-            y += label_area;
+    if (labels)
+    {
+        if (echart_labels_update(labels))
+        {
+            r = enesim_renderer_ref(echart_labels_renderer_get(labels));
+            ECHART_RENDERER_LAYER_ADD(c, r, ENESIM_ROP_BLEND);
         }
+        echart_labels_free(labels);
     }
 
     /* draw the border of the chart */
@@ -285,6 +319,50 @@ _echart_grid_layout_renderer_get(const Echart_Chart *chart,
     return c;
 }
 
+/* stores the generations the renderer is built from, returns whether they changed */
+static Eina_Bool
+_echart_column_changed(Echart_Column *thiz, const Echart_Data *data)
+{
+    unsigned int count;
+    unsigned int i;
+    Eina_Bool changed;
+
+    changed = !thiz->renderer || (thiz->data != data) ||
+        echart_chart_changes_get(thiz->chart, thiz->chart_generation) ||
+        echart_data_changes_get(data, thiz->data_generation);
+
+    count = echart_data_items_count(data);
+    if (count != thiz->generations_count)
+    {
+        unsigned int *generations;
+
+        generations = (unsigned int *)realloc(thiz->generations, count * sizeof(unsigned int));
+        if (!generations && count)
+            return EINA_TRUE;
+        thiz->generations = generations;
+        thiz->generations_count = count;
+        changed = EINA_TRUE;
+    }
+
+    for (i = 0; i < count; i++)
+    {
+        unsigned int generation;
+
+        generation = echart_data_item_generation_get(echart_data_items_get(data, i));
+        if (generation != thiz->generations[i])
+        {
+            thiz->generations[i] = generation;
+            changed = EINA_TRUE;
+        }
+    }
+
+    thiz->data = data;
+    thiz->chart_generation = echart_chart_generation_get(thiz->chart);
+    thiz->data_generation = echart_data_generation_get(data);
+
+    return changed;
+}
+
 /**
  * @endcond
  */
@@ -308,6 +386,9 @@ echart_column_chart_free(Echart_Column *thiz)
     if (!thiz)
         return;
 
+    if (thiz->renderer)
+        enesim_renderer_unref(thiz->renderer);
+    free(thiz->generations);
     free(thiz);
 }
 
@@ -317,8 +398,17 @@ echart_column_chart_set(Echart_Column *thiz, const Echart_Chart *chart)
     if (!thiz || !chart)
         return;
     thiz->chart = chart;
+    if (thiz->renderer)
+        enesim_renderer_unref(thiz->renderer);
+    thiz->renderer = NULL;
 }
 
+/*
+ * The renderer is kept by the column and returned with a new reference as
+ * long as the chart, its data and its items have not changed. Unlike the
+ * line, the scene is not patched: any change builds a new renderer, the
+ * ones returned before being left as they are.
+ */
 EAPI Enesim_Renderer *
 echart_column_renderer_get(Echart_Column *thiz)
 {
@@ -327,8 +417,14 @@ echart_column_renderer_get(Echart_Column *thiz)
     const Echart_Data_Item *absciss;
     Enesim_Rectangle geom;
     Enesim_Renderer *r;
+    Echart_Bars *bars;
+    Enesim_Color *palette;
     double bar_width;
     double data_area;
+    double vmin;
+    double vmax;
+    double y_scale;
+    double y_zero;
     int n_data;
     int n_items;
     int i;
@@ -338,49 +434,106 @@ echart_column_renderer_get(Echart_Column *thiz)
     chart = thiz->chart;
     data = echart_chart_data_get(chart);
 
+    if (!_echart_column_changed(thiz, data))
+        return enesim_renderer_ref(thiz->renderer);
+
     absciss = echart_data_items_get(data, 0);
  
     /* define the layout */
     r = _echart_grid_layout_renderer_get(thiz->chart, absciss, NULL, EINA_TRUE, EINA_FALSE, &geom);
 
     /* define the bars which at most should be 80% of the whole area defined for it */
-    n_data = eina_list_count(echart_data_item_values_get(absciss));
+    n_data = echart_data_item_values_count(absciss);
     data_area = geom.w / (n_data + 1);
 
     n_items = echart_data_items_count(data);
     bar_width = (data_area * 0.8) / (n_items - 1);
     start_x = (geom.x + data_area) - (data_area * 0.4);
 
+    /*
+     * the heights are scaled on the interval of all the values, 0 included,
+     * so that the bars of the different items can be compared
+     */
+    vmin = 0;
+    vmax = 0;
+    for (i = 1; i < n_items; i++)
+    {
+        double imin;
+        double imax;
+
+        echart_data_item_interval_get(echart_data_items_get(data, i), &imin, &imax);
+        if (vmin > imin)
+            vmin = imin;
+        if (vmax < imax)
+            vmax = imax;
+    }
+    if (vmax <= vmin)
+        vmax = vmin + 1;
+    y_scale = geom.h / (vmax - vmin);
+    y_zero = geom.y + vmax * y_scale;
+
+    /* all the bars are filled by a single renderer */
+    bars = echart_bars_new();
+    palette = (Enesim_Color *)malloc(n_items * sizeof(Enesim_Color));
+    if (!bars || !palette)
+    {
+        ERR("Could not create the bars");
+        goto end;
+    }
+
     for (i = 1; i < n_items; i++)
     {
-        const Echart_Data_Item *item = echart_data_items_get(data, i);
-        Enesim_Color color;
-        const Eina_List *l;
         uint8_t ca, cr, cg, cb;
-        double *d;
 
-        enesim_argb_components_to(echart_data_item_color_get(item).area, &ca, &cr, &cg, &cb);
-        enesim_color_components_from(&color, ca, cr, cg, cb);
+        enesim_argb_components_to(echart_data_item_color_get(echart_data_items_get(data, i)).area, &ca, &cr, &cg, &cb);
+        enesim_color_components_from(&palette[i - 1], ca, cr, cg, cb);
+    }
+    echart_bars_palette_set(bars, palette, n_items - 1);
 
+    for (i = 1; i < n_items; i++)
+    {
+        const Echart_Data_Item *item = echart_data_items_get(data, i);
+        Echart_Buffer buffer = { NULL, 0 };
+        const double *values;
+        unsigned int count;
+        unsigned int nbr;
+        unsigned int j;
+        unsigned int k;
+
+        count = echart_data_item_values_count(item);
         x = start_x + ((i - 1) * bar_width);
-        EINA_LIST_FOREACH(echart_data_item_values_get(item), l, d)
+        for (j = 0; j < count; j += nbr)
         {
-            Enesim_Renderer *b;
-            double h;
-
-            b = enesim_renderer_rectangle_new();
-            enesim_renderer_rectangle_position_set(b, x, geom.y);
-            /* TODO instead of geom.h we need to calculate the percentage based on min/max values */
-            enesim_renderer_rectangle_size_set(b, bar_width, geom.h);
+            nbr = echart_data_fetch_count(j, count);
+            values = echart_data_item_values_fetch(item, j, nbr, &buffer);
+            if (!values)
+                break;
+
+            for (k = 0; k < nbr; k++)
+            {
+                echart_bars_add(bars, x, bar_width, y_zero, y_zero - values[k] * y_scale, i - 1);
+                x += data_area;
+            }
+        }
+        echart_buffer_free(&buffer);
+    }
 
-            enesim_renderer_shape_fill_color_set(b, color);
+    if (echart_bars_update(bars))
+    {
+        Enesim_Renderer *b;
 
-            enesim_renderer_shape_draw_mode_set(b, ENESIM_RENDERER_SHAPE_DRAW_MODE_FILL);
-            ECHART_RENDERER_LAYER_ADD(r, b, ENESIM_ROP_BLEND);
-            x += data_area;
-        }
+        b = enesim_renderer_ref(echart_bars_renderer_get(bars));
+        ECHART_RENDERER_LAYER_ADD(r, b, ENESIM_ROP_BLEND);
     }
-    
+
+  end:
+    free(palette);
+    echart_bars_free(bars);
+
+    if (thiz->renderer)
+        enesim_renderer_unref(thiz->renderer);
+    thiz->renderer = enesim_renderer_ref(r);
+
     return r;
 }
 
@@ -33,305 +33,2246 @@
  * @cond LOCAL
  */
 
+#define ECHART_DATA_ITEM_VALUES_STEP 16
+
+typedef struct _Echart_Deque_Entry Echart_Deque_Entry;
+typedef struct _Echart_Deque Echart_Deque;
+
+struct _Echart_Deque_Entry
+{
+    uint64_t seq;
+    double value;
+};
+
+/*
+ * monotonic deque of the values of a sliding window of at most capacity
+ * values, with their sequence numbers, used to maintain the minimum or the
+ * maximum of the window in O(1) amortized
+ */
+struct _Echart_Deque
+{
+    Echart_Deque_Entry *entries;
+    unsigned int capacity;
+    unsigned int head;
+    unsigned int count;
+};
+
 struct _Echart_Data_Item
 {
+    /* arena of the data the item has been created for, if any */
+    Echart_Arena *arena;
+    /* next item created in the same arena */
+    Echart_Data_Item *arena_next;
     char *title;
     Echart_Colors color;
-    Eina_List *values;
+    /* type of the owned values, set at creation */
+    Echart_Value_Type type;
+    /* owned array of values, of doubles in ring mode, or caller memory when bound */
+    unsigned char *values;
+    size_t values_stride;
+    Echart_Value_Type values_type;
+    unsigned int values_count;
+    unsigned int values_alloc;
+    Eina_Free_Cb values_free_cb;
+    /* ring mode: values_alloc is the capacity, values_head the oldest value */
+    unsigned int values_head;
+    /* incremented each time already stored values are changed */
+    unsigned int values_reset;
+    struct
+    {
+        /* count of evicted values, which is 0 outside of ring mode */
+        uint64_t first;
+        Echart_Deque min;
+        Echart_Deque max;
+    } ring;
+    /* compressed values, values being then unused */
+    Echart_Codec *codec;
+    /* shared mode: values are in the published buffer, never moved */
+    Echart_Shared *shared;
+    Echart_Shared_Buffer *shared_buffer;
+    /* optional level of detail pyramid */
+    Echart_Lod *lod;
+    unsigned int lod_reset;
+    /* ring.first when the pyramid was cleared, the evicted values are kept */
+    uint64_t lod_first;
+    /* compatibility view returned by echart_data_item_values_get() */
+    Eina_List *values_list;
+    double *values_shadow;
+    unsigned int values_bound : 1;
+    unsigned int values_arena : 1;
+    unsigned int values_ring : 1;
+    unsigned int values_list_dirty : 1;
+    unsigned int interval_dirty : 1;
+    double vmin;
+    double vmax;
+    Echart_Generation generation;
+};
+
+typedef struct _Echart_Data_Stacked_Row Echart_Data_Stacked_Row;
+
+struct _Echart_Data_Stacked_Row
+{
+    double *values;
     double vmin;
     double vmax;
+    unsigned int reset;
+    /* interval of the window when the items are rings */
+    Echart_Deque min;
+    Echart_Deque max;
 };
 
 struct _Echart_Data
 {
+    /* when set, the data, its items, titles and values are allocated in it */
+    Echart_Arena *arena;
+    /* items created in the arena, attached or not, released with the data */
+    Echart_Data_Item *arena_items;
     char *title;
     Echart_Data_Item *absciss;
-    Eina_List *items;
+    Echart_Data_Item **items;
+    unsigned int items_count;
+    unsigned int items_alloc;
+    /* title -> item, built on the first lookup */
+    Eina_Hash *titles;
+    Echart_Generation generation;
+    /* epochs of the readers of the data, in shared mode */
+    Echart_Shared *shared;
+    /* for a snapshot, the epochs of the source and the reader slot */
+    Echart_Shared *snapshot;
+    unsigned int snapshot_slot;
+    /*
+     * cached stacked view of the items, extended on append. When the items
+     * are rings, the values evicted from them are skipped: values[0] of the
+     * rows is the value of sequence number first, not of index 0.
+     */
+    struct
+    {
+        Echart_Data_Stacked_Row *rows;
+        unsigned int rows_count;
+        unsigned int count;
+        unsigned int alloc;
+        unsigned int ring;
+        uint64_t first;
+        unsigned int head;
+    } stacked;
 };
 
-/**
- * @endcond
+static size_t
+_echart_value_type_size(Echart_Value_Type type)
+{
+    switch (type)
+    {
+        case ECHART_VALUE_TYPE_DOUBLE:
+            return sizeof(double);
+        case ECHART_VALUE_TYPE_FLOAT:
+            return sizeof(float);
+        case ECHART_VALUE_TYPE_INT32:
+            return sizeof(int32_t);
+        case ECHART_VALUE_TYPE_INT64:
+            return sizeof(int64_t);
+        default:
+            return 0;
+    }
+}
+
+/*
+ * a value of a compressed item is decoded from the start of its block, so
+ * it costs up to a block of values: the ranges are read with
+ * echart_data_item_values_fetch(), transform() or gather() instead
  */
+static inline double
+_echart_data_item_value(const Echart_Data_Item *item, unsigned int idx)
+{
+    const unsigned char *v;
 
-/*============================================================================*
- *                                 Global                                     *
- *============================================================================*/
+    if (item->codec)
+        return echart_codec_value_get(item->codec, idx);
+
+    if (item->values_ring)
+    {
+        idx += item->values_head;
+        if (idx >= item->values_alloc)
+            idx -= item->values_alloc;
+    }
+
+    v = item->values + idx * item->values_stride;
+    switch (item->values_type)
+    {
+        case ECHART_VALUE_TYPE_FLOAT:
+            return *(const float *)v;
+        case ECHART_VALUE_TYPE_INT32:
+            return (double)*(const int32_t *)v;
+        case ECHART_VALUE_TYPE_INT64:
+            return (double)*(const int64_t *)v;
+        default:
+            return *(const double *)v;
+    }
+}
+
+/*
+ * count doubles converted to the type of the owned values, at index idx.
+ * The integers are rounded and saturated, NaN being stored as 0.
+ */
+static void
+_echart_data_item_values_store(Echart_Data_Item *item, unsigned int idx, const double *values, unsigned int count)
+{
+    unsigned int i;
+
+    switch (item->values_type)
+    {
+        case ECHART_VALUE_TYPE_FLOAT:
+            for (i = 0; i < count; i++)
+                ((float *)item->values)[idx + i] = (float)values[i];
+            break;
+        case ECHART_VALUE_TYPE_INT32:
+            for (i = 0; i < count; i++)
+                ((int32_t *)item->values)[idx + i] = echart_value_int32_get(values[i]);
+            break;
+        case ECHART_VALUE_TYPE_INT64:
+            for (i = 0; i < count; i++)
+                ((int64_t *)item->values)[idx + i] = echart_value_int64_get(values[i]);
+            break;
+        default:
+            memcpy((double *)item->values + idx, values, count * sizeof(double));
+            break;
+    }
+}
+
+/*
+ * the values of index in [start, start + count) as at most 2 runs of
+ * contiguous values of type values_type: returns the count of values of the
+ * first run, 0 if the values are interleaved with other data
+ */
+static unsigned int
+_echart_data_item_values_runs(const Echart_Data_Item *item, unsigned int start, unsigned int count,
+                              const unsigned char **run1, const unsigned char **run2)
+{
+    unsigned int first;
+
+    *run2 = NULL;
+    if (item->codec ||
+        (item->values_stride != _echart_value_type_size(item->values_type)))
+        return 0;
+
+    if (!item->values_ring)
+    {
+        *run1 = item->values + start * item->values_stride;
+        return count;
+    }
+
+    first = item->values_head + start;
+    if (first >= item->values_alloc)
+        first -= item->values_alloc;
+    *run1 = item->values + first * item->values_stride;
+    if (first + count <= item->values_alloc)
+        return count;
+
+    *run2 = item->values;
+    return item->values_alloc - first;
+}
+
+static Eina_Bool
+_echart_deque_init(Echart_Deque *dq, unsigned int capacity)
+{
+    dq->entries = (Echart_Deque_Entry *)malloc(capacity * sizeof(Echart_Deque_Entry));
+    dq->capacity = dq->entries ? capacity : 0;
+    dq->head = 0;
+    dq->count = 0;
+
+    return !!dq->entries;
+}
+
+static void
+_echart_deque_free(Echart_Deque *dq)
+{
+    free(dq->entries);
+    memset(dq, 0, sizeof(Echart_Deque));
+}
+
+static void
+_echart_deque_push(Echart_Deque *dq, uint64_t seq, double v, Eina_Bool is_max)
+{
+    unsigned int idx;
+
+    while (dq->count)
+    {
+        double b;
+
+        idx = dq->head + dq->count - 1;
+        if (idx >= dq->capacity)
+            idx -= dq->capacity;
+        b = dq->entries[idx].value;
+        if (is_max ? (b > v) : (b < v))
+            break;
+        dq->count--;
+    }
+
+    idx = dq->head + dq->count;
+    if (idx >= dq->capacity)
+        idx -= dq->capacity;
+    dq->entries[idx].seq = seq;
+    dq->entries[idx].value = v;
+    dq->count++;
+}
+
+/* the values of sequence number lower than seq leave the window */
+static void
+_echart_deque_evict(Echart_Deque *dq, uint64_t seq)
+{
+    while (dq->count && (dq->entries[dq->head].seq < seq))
+    {
+        dq->head++;
+        if (dq->head == dq->capacity)
+            dq->head = 0;
+        dq->count--;
+    }
+}
+
+static inline double
+_echart_deque_front(const Echart_Deque *dq)
+{
+    return dq->entries[dq->head].value;
+}
+
+/*
+ * The oldest value is evicted by moving the head of the ring: the values
+ * which are left are not changed, so the caches built on them, the stacked
+ * view and the level of detail, only skip the evicted ones.
+ */
+static void
+_echart_data_item_ring_push(Echart_Data_Item *item, double value)
+{
+    double *values;
+    unsigned int capacity;
+    uint64_t seq;
+
+    values = (double *)item->values;
+    capacity = item->values_alloc;
+
+    /* evict the oldest value */
+    if (item->values_count == capacity)
+    {
+        item->ring.first++;
+        _echart_deque_evict(&item->ring.min, item->ring.first);
+        _echart_deque_evict(&item->ring.max, item->ring.first);
+        item->values_head++;
+        if (item->values_head == capacity)
+            item->values_head = 0;
+        item->values_count--;
+        echart_generation_bump(&item->generation, ECHART_CHANGE_SHIFT);
+    }
+
+    seq = item->ring.first + item->values_count;
+    values[seq % capacity] = value;
+    item->values_count++;
+
+    _echart_deque_push(&item->ring.min, seq, value, EINA_FALSE);
+    _echart_deque_push(&item->ring.max, seq, value, EINA_TRUE);
+    item->vmin = _echart_deque_front(&item->ring.min);
+    item->vmax = _echart_deque_front(&item->ring.max);
+    item->interval_dirty = 0;
+}
+
+static void
+_echart_data_item_ring_free(Echart_Data_Item *item)
+{
+    _echart_deque_free(&item->ring.min);
+    _echart_deque_free(&item->ring.max);
+    memset(&item->ring, 0, sizeof(item->ring));
+    item->values_head = 0;
+    item->values_ring = 0;
+}
+
+static void
+_echart_data_item_values_release(Echart_Data_Item *item)
+{
+    if (item->shared_buffer)
+        echart_shared_buffer_free(item->shared_buffer);
+    else if (item->values_bound)
+    {
+        if (item->values_free_cb)
+            item->values_free_cb(item->values);
+    }
+    else if (!item->values_arena)
+        free(item->values);
+    _echart_data_item_ring_free(item);
+    echart_codec_free(item->codec);
+    item->codec = NULL;
+
+    item->values = NULL;
+    item->values_stride = _echart_value_type_size(item->type);
+    item->values_type = item->type;
+    item->values_count = 0;
+    item->values_alloc = 0;
+    item->values_free_cb = NULL;
+    item->values_bound = 0;
+    item->values_arena = 0;
+    item->shared = NULL;
+    item->shared_buffer = NULL;
+    item->values_list_dirty = 1;
+    item->interval_dirty = 1;
+    item->values_reset++;
+    echart_generation_bump(&item->generation, ECHART_CHANGE_RESET);
+}
+
+/* the interval of the values of index in [start, end), with start < end */
+static void
+_echart_data_item_values_interval(const Echart_Data_Item *item, unsigned int start, unsigned int end, double *vmin, double *vmax)
+{
+    const unsigned char *run1;
+    const unsigned char *run2;
+    unsigned int n;
+    unsigned int i;
+
+    if (item->codec)
+    {
+        echart_codec_interval_get(item->codec, start, end, vmin, vmax);
+        return;
+    }
+
+    n = _echart_data_item_values_runs(item, start, end - start, &run1, &run2);
+    if (n)
+    {
+        echart_simd_interval_typed_get(run1, item->values_type, n, vmin, vmax);
+        if (run2)
+        {
+            double min;
+            double max;
+
+            echart_simd_interval_typed_get(run2, item->values_type, end - start - n, &min, &max);
+            if (min < *vmin) *vmin = min;
+            if (max > *vmax) *vmax = max;
+        }
+        return;
+    }
+
+    *vmin = *vmax = _echart_data_item_value(item, start);
+    for (i = start + 1; i < end; i++)
+    {
+        double v;
+
+        v = _echart_data_item_value(item, i);
+        if (v < *vmin) *vmin = v;
+        if (v > *vmax) *vmax = v;
+    }
+}
+
+static void
+_echart_data_item_interval_update(Echart_Data_Item *item)
+{
+    if (!item->interval_dirty)
+        return;
+
+    item->interval_dirty = 0;
+    if (!item->values_count)
+    {
+        item->vmin = 0.0;
+        item->vmax = 0.0;
+        return;
+    }
+
+    _echart_data_item_values_interval(item, 0, item->values_count, &item->vmin, &item->vmax);
+}
+
+/*
+ * The values evicted from a ring stay at the start of the pyramid, value idx
+ * of the item being its sample idx + offset. It is rebuilt once the evicted
+ * values are more than the values left, which is O(1) amortized per value.
+ */
+static inline unsigned int
+_echart_data_item_lod_offset(const Echart_Data_Item *item)
+{
+    return (unsigned int)(item->ring.first - item->lod_first);
+}
+
+/* extends the pyramid with the values added since its last update */
+static void
+_echart_data_item_lod_update(Echart_Data_Item *item)
+{
+    Echart_Buffer buffer = { NULL, 0 };
+    const double *values;
+    unsigned int count;
+    unsigned int nbr;
+    uint64_t offset;
+
+    /* the view of a snapshot is extended by the writer only */
+    if (!item->lod || echart_lod_view_get(item->lod))
+        return;
+
+    offset = item->ring.first - item->lod_first;
+    if ((item->lod_reset != item->values_reset) ||
+        (offset > item->values_count) ||
+        (offset > echart_lod_count(item->lod)))
+    {
+        echart_lod_clear(item->lod);
+        item->lod_reset = item->values_reset;
+        item->lod_first = item->ring.first;
+        offset = 0;
+    }
+
+    count = echart_lod_count(item->lod) - (unsigned int)offset;
+    if (count >= item->values_count)
+        return;
+
+    /*
+     * appended block by block. On failure, the pyramid keeps the blocks
+     * already appended and is extended at the next update
+     */
+    for (; count < item->values_count; count += nbr)
+    {
+        nbr = echart_data_fetch_count(count, item->values_count);
+        values = echart_data_item_values_fetch(item, count, nbr, &buffer);
+        if (!values || !echart_lod_append(item->lod, values, nbr))
+        {
+            ERR("Could not update the level of detail of the item");
+            break;
+        }
+    }
+    echart_buffer_free(&buffer);
+}
+
+static Eina_Bool
+_echart_data_item_values_grow(Echart_Data_Item *item, unsigned int count)
+{
+    unsigned char *values;
+    unsigned int alloc;
+
+    if (item->values_count + count <= item->values_alloc)
+        return EINA_TRUE;
+
+    alloc = item->values_alloc ? item->values_alloc : ECHART_DATA_ITEM_VALUES_STEP;
+    while (alloc < item->values_count + count)
+        alloc *= 2;
+
+    if (item->shared)
+    {
+        Echart_Shared_Buffer *buffer;
+
+        /* the readers may still read the current buffer */
+        buffer = echart_shared_buffer_new(alloc * item->values_stride);
+        if (!buffer)
+            return EINA_FALSE;
+        values = echart_shared_buffer_values_get(buffer);
+        if (item->values_count)
+            memcpy(values, item->values, item->values_count * item->values_stride);
+        echart_shared_buffer_publish(buffer, item->values_count);
+        echart_shared_buffer_replace(item->shared, &item->shared_buffer, buffer);
+    }
+    else if (item->arena && (!item->values || item->values_arena))
+    {
+        values = (unsigned char *)echart_arena_realloc(item->arena, item->values,
+                                                       item->values_alloc * item->values_stride,
+                                                       alloc * item->values_stride);
+        if (!values)
+            return EINA_FALSE;
+        item->values_arena = 1;
+    }
+    else
+    {
+        values = (unsigned char *)realloc(item->values, alloc * item->values_stride);
+        if (!values)
+            return EINA_FALSE;
+    }
+
+    item->values = values;
+    item->values_alloc = alloc;
+
+    return EINA_TRUE;
+}
+
+/* the memory of the values of the item in shared mode, or back in an array */
+static void *
+_echart_data_item_shared_alloc(const Echart_Data_Item *item, Eina_Bool shared)
+{
+    unsigned int alloc;
+
+    alloc = item->values_alloc ? item->values_alloc : ECHART_DATA_ITEM_VALUES_STEP;
+    if (shared)
+        return echart_shared_buffer_new(alloc * item->values_stride);
+
+    return malloc(alloc * item->values_stride);
+}
+
+/*
+ * moves the values of the item to mem, allocated by
+ * _echart_data_item_shared_alloc() for the new mode, which can not fail
+ */
+static void
+_echart_data_item_shared_set(Echart_Data_Item *item, Echart_Shared *shared, void *mem)
+{
+    Echart_Shared_Buffer *buffer;
+    unsigned char *values;
+
+    if (shared)
+    {
+        buffer = (Echart_Shared_Buffer *)mem;
+        values = echart_shared_buffer_values_get(buffer);
+        if (item->values_count)
+            memcpy(values, item->values, item->values_count * item->values_stride);
+        echart_shared_buffer_publish(buffer, item->values_count);
+        if (!item->values_arena)
+            free(item->values);
+    }
+    else
+    {
+        buffer = NULL;
+        values = (unsigned char *)mem;
+        if (item->values_count)
+            memcpy(values, item->values, item->values_count * item->values_stride);
+        echart_shared_buffer_free(item->shared_buffer);
+    }
+
+    if (!item->values_alloc)
+        item->values_alloc = ECHART_DATA_ITEM_VALUES_STEP;
+    item->values = values;
+    item->values_arena = 0;
+    item->shared = shared;
+    item->shared_buffer = buffer;
+    item->values_list_dirty = 1;
+    if (item->lod)
+        echart_lod_shared_set(item->lod, shared);
+}
+
+/*
+ * called by a reader: the snapshot item is bound to the published buffer of
+ * item, which is not freed before the reader leaves its epoch
+ */
+static Echart_Data_Item *
+_echart_data_item_snapshot_new(const Echart_Data_Item *item, const Echart_Shared_Buffer *buffer, unsigned int count)
+{
+    Echart_Data_Item *snapshot;
+
+    snapshot = echart_data_item_new_typed(item->type);
+    if (!snapshot)
+        return NULL;
+
+    echart_data_item_values_bind(snapshot, echart_shared_buffer_values_get(buffer),
+                                 count, item->values_stride, item->values_type, NULL);
+    if (item->title)
+        echart_data_item_title_set(snapshot, item->title);
+    snapshot->color = item->color;
+
+    /* the view only reads the pyramid of the writer, nothing is rebuilt */
+    if (item->lod)
+    {
+        snapshot->lod = echart_lod_view_new(item->lod, count);
+        if (!snapshot->lod)
+        {
+            echart_data_item_free(snapshot);
+            return NULL;
+        }
+        snapshot->lod_reset = snapshot->values_reset;
+    }
+
+    return snapshot;
+}
+
+static void
+_echart_data_stacked_free(Echart_Data *data)
+{
+    unsigned int i;
+
+    for (i = 0; i < data->stacked.rows_count; i++)
+    {
+        free(data->stacked.rows[i].values);
+        _echart_deque_free(&data->stacked.rows[i].min);
+        _echart_deque_free(&data->stacked.rows[i].max);
+    }
+    free(data->stacked.rows);
+    memset(&data->stacked, 0, sizeof(data->stacked));
+}
 
-Echart_Data *
-echart_data_stacked_get(const Echart_Data *data)
+/*
+ * The stacked values of item i are the sums of the values of the items 1 to
+ * i, item 0 being kept as is. Only the columns appended since the last call
+ * are computed, unless the items or their stored values have changed. When
+ * the items are rings of the same capacity advancing in lockstep, the
+ * columns evicted from them are skipped, and the rows are only moved back
+ * to the start of their memory when its end is reached.
+ */
+static Eina_Bool
+_echart_data_stacked_update(Echart_Data *data)
 {
-    Echart_Data *stacked;
     Echart_Data_Item *item;
-    Echart_Data_Item *item_prev;
-    Echart_Data_Item *stacked_item;
+    Echart_Buffer buffer = { NULL, 0 };
+    uint64_t first;
+    unsigned int rows_count;
+    unsigned int count;
+    unsigned int start;
+    unsigned int ring;
+    unsigned int head;
     unsigned int i;
     unsigned int j;
 
-    stacked = echart_data_new();
-    if (!stacked)
-        return NULL;
+    rows_count = data->items_count;
+    if (!rows_count)
+        return EINA_FALSE;
+
+    count = data->absciss ? data->absciss->values_count : 0;
+    for (i = 0; i < rows_count; i++)
+    {
+        if (data->items[i]->values_count < count)
+            count = data->items[i]->values_count;
+    }
 
-    stacked->title = strdup(data->title);
-    if (!stacked->title)
-        goto free_data;
+    /* the deques of the rows are only used when all the items are rings */
+    first = data->items[0]->ring.first;
+    ring = data->items[0]->values_ring ? data->items[0]->values_alloc : 0;
+    for (i = 1; i < rows_count; i++)
+    {
+        if (!data->items[i]->values_ring || (data->items[i]->values_alloc != ring))
+            ring = 0;
+    }
 
-    for (i = 0; i < eina_list_count(data->items); i++)
+    start = data->stacked.count;
+    if ((rows_count != data->stacked.rows_count) || (ring != data->stacked.ring))
+    {
+        _echart_data_stacked_free(data);
+        data->stacked.rows = (Echart_Data_Stacked_Row *)calloc(rows_count, sizeof(Echart_Data_Stacked_Row));
+        if (!data->stacked.rows)
+            return EINA_FALSE;
+        data->stacked.rows_count = rows_count;
+        data->stacked.ring = ring;
+        for (i = 0; ring && (i < rows_count); i++)
+        {
+            if (!_echart_deque_init(&data->stacked.rows[i].min, ring) ||
+                !_echart_deque_init(&data->stacked.rows[i].max, ring))
+            {
+                _echart_data_stacked_free(data);
+                return EINA_FALSE;
+            }
+        }
+        start = 0;
+    }
+    else
     {
-        /* absciss  and 1st value */
-        if ((i == 0) || (i == 1))
+        for (i = 0; i < rows_count; i++)
         {
-            item = eina_list_nth(data->items, i);
-            stacked_item = echart_data_item_new();
-            stacked_item->title = strdup(item->title);
-            stacked_item->color = item->color;
-            stacked_item->vmin = item->vmin;
-            stacked_item->vmax = item->vmax;
-            stacked_item->values = eina_list_clone(item->values);
-            echart_data_items_set(stacked, stacked_item);
+            if ((data->items[i]->values_reset != data->stacked.rows[i].reset) ||
+                (data->items[i]->ring.first != first))
+                start = 0;
         }
+    }
+
+    /* the columns evicted from the rings since the last call are skipped */
+    if (start && (first != data->stacked.first))
+    {
+        if (!ring || (first < data->stacked.first) || (first - data->stacked.first >= start))
+            start = 0;
         else
         {
-            item_prev = eina_list_nth(data->items, i-1);
-            item = eina_list_nth(data->items, i);
-            stacked_item = echart_data_item_new();
-            stacked_item->title = strdup(item->title);
-            stacked_item->color = item->color;
-            stacked_item->vmin = item->vmin;
-            stacked_item->vmax = item->vmax;
-            for (j = 0; j < eina_list_count(item->values); j++)
+            start -= (unsigned int)(first - data->stacked.first);
+            data->stacked.head += (unsigned int)(first - data->stacked.first);
+            for (i = 0; ring && (i < rows_count); i++)
+            {
+                _echart_deque_evict(&data->stacked.rows[i].min, first);
+                _echart_deque_evict(&data->stacked.rows[i].max, first);
+            }
+        }
+    }
+    data->stacked.first = first;
+
+    if (count < start)
+        start = 0;
+    if (!start)
+    {
+        data->stacked.head = 0;
+        for (i = 0; ring && (i < rows_count); i++)
+        {
+            data->stacked.rows[i].min.count = 0;
+            data->stacked.rows[i].max.count = 0;
+        }
+    }
+
+    /* the columns left are moved back once the end of the rows is reached */
+    if ((data->stacked.head + count > data->stacked.alloc) && data->stacked.head)
+    {
+        for (i = 0; i < rows_count; i++)
+        {
+            memmove(data->stacked.rows[i].values,
+                    data->stacked.rows[i].values + data->stacked.head,
+                    start * sizeof(double));
+        }
+        data->stacked.head = 0;
+    }
+
+    /*
+     * rows of rings get twice the room of the window, so that they are
+     * moved at most once every count evictions
+     */
+    if (count > data->stacked.alloc)
+    {
+        unsigned int alloc;
+
+        alloc = data->stacked.alloc ? data->stacked.alloc : ECHART_DATA_ITEM_VALUES_STEP;
+        while (alloc < (ring ? 2 * count : count))
+            alloc *= 2;
+        for (i = 0; i < rows_count; i++)
+        {
+            double *values;
+
+            values = (double *)realloc(data->stacked.rows[i].values, alloc * sizeof(double));
+            if (!values)
+            {
+                _echart_data_stacked_free(data);
+                return EINA_FALSE;
+            }
+            data->stacked.rows[i].values = values;
+        }
+        data->stacked.alloc = alloc;
+    }
+
+    head = data->stacked.head;
+    if (start < count)
+    {
+        for (i = 0; i < rows_count; i++)
+        {
+            Echart_Data_Stacked_Row *row;
+            const double *values;
+            double *dst;
+            double vmin;
+            double vmax;
+            unsigned int nbr;
+
+            item = data->items[i];
+            row = data->stacked.rows + i;
+            dst = row->values + head;
+
+            /* read block by block, a compressed item is never decoded as a whole */
+            for (j = start; j < count; j += nbr)
             {
-                double d1;
-                double d2;
+                nbr = echart_data_fetch_count(j, count);
+                values = echart_data_item_values_fetch(item, j, nbr, &buffer);
+                if (!values)
+                {
+                    echart_buffer_free(&buffer);
+                    _echart_data_stacked_free(data);
+                    return EINA_FALSE;
+                }
 
-                d1 = *(double *)eina_list_nth(item_prev->values, j);
-                d2 = *(double *)eina_list_nth(item->values, j);
-                echart_data_item_value_add(stacked_item, d1 + d2);
-                printf("%f   %f %f\n", d1, d2, d1 + d2);
+                if (i >= 2)
+                {
+                    const double *prev;
+                    unsigned int k;
+
+                    prev = data->stacked.rows[i - 1].values + head + j;
+                    for (k = 0; k < nbr; k++)
+                        dst[j + k] = prev[k] + values[k];
+                }
+                else
+                    memcpy(dst + j, values, nbr * sizeof(double));
+            }
+
+            if (ring)
+            {
+                for (j = start; j < count; j++)
+                {
+                    _echart_deque_push(&row->min, first + j, dst[j], EINA_FALSE);
+                    _echart_deque_push(&row->max, first + j, dst[j], EINA_TRUE);
+                }
+                row->vmin = _echart_deque_front(&row->min);
+                row->vmax = _echart_deque_front(&row->max);
             }
-            echart_data_items_set(stacked, stacked_item);
+            else
+            {
+                echart_simd_interval_get(dst + start, count - start, &vmin, &vmax);
+                if ((start == 0) || (vmin < row->vmin)) row->vmin = vmin;
+                if ((start == 0) || (vmax > row->vmax)) row->vmax = vmax;
+            }
+            row->reset = item->values_reset;
+        }
+        echart_buffer_free(&buffer);
+    }
+    else if (ring && count)
+    {
+        /* only evictions */
+        for (i = 0; i < rows_count; i++)
+        {
+            data->stacked.rows[i].vmin = _echart_deque_front(&data->stacked.rows[i].min);
+            data->stacked.rows[i].vmax = _echart_deque_front(&data->stacked.rows[i].max);
         }
     }
+    data->stacked.count = count;
+
+    return EINA_TRUE;
+}
+
+/**
+ * @endcond
+ */
+
+/*============================================================================*
+ *                                 Global                                     *
+ *============================================================================*/
+
+double *
+echart_buffer_get(Echart_Buffer *buffer, unsigned int size)
+{
+    if (size > buffer->size)
+    {
+        double *data;
+
+        data = (double *)realloc(buffer->data, size * sizeof(double));
+        if (!data)
+            return NULL;
+
+        buffer->data = data;
+        buffer->size = size;
+    }
+
+    return buffer->data;
+}
+
+void
+echart_buffer_free(Echart_Buffer *buffer)
+{
+    free(buffer->data);
+    buffer->data = NULL;
+    buffer->size = 0;
+}
+
+const double *
+echart_data_item_values_fetch(const Echart_Data_Item *item, unsigned int start, unsigned int count, Echart_Buffer *buffer)
+{
+    double *d;
+    unsigned int i;
+
+    if (start + count > item->values_count)
+        return NULL;
+
+    /*
+     * decoded in the scratch buffer only. The readers fetch the values of a
+     * compressed item by blocks of echart_data_fetch_count() values, so that
+     * it is never decoded as a whole
+     */
+    if (item->codec)
+    {
+        d = echart_buffer_get(buffer, count);
+        if (!d)
+            return NULL;
+
+        echart_codec_decode(item->codec, start, count, d);
+        return d;
+    }
+
+    if (item->values_ring)
+    {
+        unsigned int first;
+
+        first = item->values_head + start;
+        if (first >= item->values_alloc)
+            first -= item->values_alloc;
+        if (first + count <= item->values_alloc)
+            return (const double *)item->values + first;
+
+        /* the range wraps around the end of the ring */
+        d = echart_buffer_get(buffer, count);
+        if (!d)
+            return NULL;
+
+        i = item->values_alloc - first;
+        memcpy(d, (const double *)item->values + first, i * sizeof(double));
+        memcpy(d + i, item->values, (count - i) * sizeof(double));
+        return d;
+    }
+
+    if ((item->values_type == ECHART_VALUE_TYPE_DOUBLE) &&
+        (item->values_stride == sizeof(double)))
+        return (const double *)item->values + start;
+
+    d = echart_buffer_get(buffer, count);
+    if (!d)
+        return NULL;
+
+    for (i = 0; i < count; i++)
+        d[i] = _echart_data_item_value(item, start + i);
+
+    return d;
+}
+
+/* res[i] = offset + scale * value(start + i), read in the type of the values */
+void
+echart_data_item_values_transform(const Echart_Data_Item *item, unsigned int start, unsigned int count,
+                                  double offset, double scale, double *res)
+{
+    const unsigned char *run1;
+    const unsigned char *run2;
+    unsigned int n;
+    unsigned int i;
+
+    if (item->codec)
+    {
+        echart_codec_decode(item->codec, start, count, res);
+        echart_simd_transform(res, count, offset, scale, res);
+        return;
+    }
+
+    n = _echart_data_item_values_runs(item, start, count, &run1, &run2);
+    if (n)
+    {
+        echart_simd_transform_typed(run1, item->values_type, n, offset, scale, res);
+        if (run2)
+            echart_simd_transform_typed(run2, item->values_type, count - n, offset, scale, res + n);
+        return;
+    }
+
+    for (i = 0; i < count; i++)
+        res[i] = offset + scale * _echart_data_item_value(item, start + i);
+}
+
+/* res[k] = value(start + indices[k]) */
+void
+echart_data_item_values_gather(const Echart_Data_Item *item, unsigned int start,
+                               const unsigned int *indices, unsigned int count, double *res)
+{
+    unsigned int k;
+
+    if (item->codec)
+    {
+        echart_codec_gather(item->codec, start, indices, count, res);
+        return;
+    }
+
+    for (k = 0; k < count; k++)
+        res[k] = _echart_data_item_value(item, start + indices[k]);
+}
+
+/* the values of the item must be sorted in increasing order */
+void
+echart_data_item_range_find(const Echart_Data_Item *item, double xmin, double xmax, unsigned int *first, unsigned int *count)
+{
+    unsigned int lo;
+    unsigned int hi;
+    unsigned int start;
+
+    /* searched with the bounds of the blocks, not value by value */
+    if (item->codec)
+    {
+        start = echart_codec_lower_bound(item->codec, xmin, EINA_FALSE);
+        lo = echart_codec_lower_bound(item->codec, xmax, EINA_TRUE);
+        *first = start;
+        *count = (lo > start) ? lo - start : 0;
+        return;
+    }
+
+    /* first value >= xmin */
+    lo = 0;
+    hi = item->values_count;
+    while (lo < hi)
+    {
+        unsigned int mid;
+
+        mid = lo + (hi - lo) / 2;
+        if (_echart_data_item_value(item, mid) < xmin)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    start = lo;
+
+    /* first value > xmax */
+    hi = item->values_count;
+    while (lo < hi)
+    {
+        unsigned int mid;
+
+        mid = lo + (hi - lo) / 2;
+        if (_echart_data_item_value(item, mid) <= xmax)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+
+    *first = start;
+    *count = lo - start;
+}
+
+unsigned int
+echart_data_item_lod_fetch(const Echart_Data_Item *item, unsigned int start, unsigned int end, unsigned int width, unsigned int *indices, unsigned int size)
+{
+    unsigned int offset;
+    unsigned int n;
+    unsigned int i;
+
+    if (!item->lod)
+        return 0;
+
+    _echart_data_item_lod_update((Echart_Data_Item *)item);
+
+    offset = _echart_data_item_lod_offset(item);
+    n = echart_lod_fetch(item->lod, start + offset, end + offset, width, indices, size);
+    if (offset)
+    {
+        for (i = 0; i < n; i++)
+            indices[i] -= offset;
+    }
+
+    return n;
+}
+
+Eina_Bool
+echart_data_stacked_update(const Echart_Data *data)
+{
+    return _echart_data_stacked_update((Echart_Data *)data);
+}
+
+/*
+ * echart_data_stacked_update() must have been called before. count is set
+ * to the number of stacked values, the least of the counts of the items.
+ */
+const double *
+echart_data_stacked_values_get(const Echart_Data *data, unsigned int idx, unsigned int *count, double *vmin, double *vmax)
+{
+    Echart_Data_Stacked_Row *row;
+
+    if (idx >= data->stacked.rows_count)
+        return NULL;
+
+    row = data->stacked.rows + idx;
+    if (count) *count = data->stacked.count;
+    if (vmin) *vmin = row->vmin;
+    if (vmax) *vmax = row->vmax;
+
+    return row->values + data->stacked.head;
+}
+
+/*============================================================================*
+ *                                   API                                      *
+ *============================================================================*/
+
+EAPI Echart_Data *
+echart_data_new(void)
+{
+    Echart_Data *data;
+
+    data = (Echart_Data *)calloc(1, sizeof(Echart_Data));
+    if (!data)
+        return NULL;
+
+    echart_generation_init(&data->generation);
+
+    return data;
+}
+
+/*
+ * All the blocks of the data are allocated in an arena of at least
+ * size_hint bytes, and released at once by echart_data_free(). Items created
+ * with echart_data_item_new_arena() share that arena.
+ */
+EAPI Echart_Data *
+echart_data_new_arena(size_t size_hint)
+{
+    Echart_Arena *arena;
+    Echart_Data *data;
+
+    arena = echart_arena_new(size_hint + sizeof(Echart_Data));
+    if (!arena)
+        return NULL;
+
+    data = (Echart_Data *)echart_arena_alloc(arena, sizeof(Echart_Data));
+    if (!data)
+    {
+        echart_arena_free(arena);
+        return NULL;
+    }
+
+    data->arena = arena;
+    echart_generation_init(&data->generation);
+
+    return data;
+}
+
+/*
+ * The absciss and the items of a snapshot are freed too, as are the items
+ * created in the arena of an arena data, whether they have been set to it
+ * or not. Any other item still belongs to the caller, and leaves the
+ * shared mode if needed.
+ */
+EAPI void
+echart_data_free(Echart_Data *data)
+{
+    Echart_Data_Item *item;
+    unsigned int i;
+
+    if (!data)
+        return;
+
+    if (data->snapshot)
+    {
+        echart_data_item_free(data->absciss);
+        for (i = 0; i < data->items_count; i++)
+            echart_data_item_free(data->items[i]);
+    }
+    else if (data->shared)
+        echart_data_shared_set(data, EINA_FALSE);
+
+    /* each arena item once, even if it is both the absciss and an item */
+    for (item = data->arena_items; item; item = item->arena_next)
+        echart_data_item_free(item);
+    if (data->titles)
+        eina_hash_free(data->titles);
+    _echart_data_stacked_free(data);
+    echart_shared_free(data->shared);
+    if (data->snapshot)
+        echart_shared_read_unlock(data->snapshot, data->snapshot_slot);
+
+    if (data->arena)
+    {
+        echart_arena_free(data->arena);
+        return;
+    }
+
+    free(data->items);
+    if (data->title)
+        free(data->title);
+    free(data);
+}
+
+EAPI void
+echart_data_title_set(Echart_Data *data, const char *title)
+{
+    if (!data || !title || !*title)
+        return;
+
+    if (data->arena)
+        data->title = echart_arena_strdup(data->arena, title);
+    else
+        data->title = strdup(title);
+    echart_generation_bump(&data->generation, ECHART_CHANGE_STYLE);
+}
+
+EAPI const char *
+echart_data_title_get(const Echart_Data *data)
+{
+    if (!data)
+        return NULL;
+
+    return data->title;
+}
+
+EAPI void
+echart_data_absciss_set(Echart_Data *data, const Echart_Data_Item *absciss)
+{
+    unsigned int count;
+
+    if (!data || !absciss)
+        return;
+
+    if (data->shared)
+    {
+        ERR("Can not set the absciss of a shared data");
+        return;
+    }
+
+    data->absciss = (Echart_Data_Item *)absciss;
+    echart_generation_bump(&data->generation, ECHART_CHANGE_DATA);
+}
+
+EAPI const Echart_Data_Item *
+echart_data_absciss_get(const Echart_Data *data)
+{
+    if (!data)
+        return NULL;
+
+    return data->absciss;
+}
+
+EAPI void
+echart_data_items_set(Echart_Data *data, Echart_Data_Item *item)
+{
+    if (!data || !item)
+        return;
+
+    if (data->shared)
+    {
+        ERR("Can not add items to a shared data");
+        return;
+    }
+
+    /* the items set before the absciss can not be checked */
+    if (data->absciss && (data->absciss->values_count != item->values_count))
+    {
+        WRN("Adding an item with different values count");
+        return;
+    }
+
+    if (data->items_count == data->items_alloc)
+    {
+        Echart_Data_Item **items;
+        unsigned int alloc;
+
+        alloc = data->items_alloc ? 2 * data->items_alloc : 8;
+        if (data->arena)
+            items = (Echart_Data_Item **)echart_arena_realloc(data->arena, data->items,
+                                                              data->items_alloc * sizeof(Echart_Data_Item *),
+                                                              alloc * sizeof(Echart_Data_Item *));
+        else
+            items = (Echart_Data_Item **)realloc(data->items, alloc * sizeof(Echart_Data_Item *));
+        if (!items)
+        {
+            ERR("Could not allocate memory for %u items", alloc);
+            return;
+        }
+        data->items = items;
+        data->items_alloc = alloc;
+    }
+
+    item->color = echart_chart_default_colors_get(data->items_count);
+    echart_generation_bump(&item->generation, ECHART_CHANGE_STYLE);
+    data->items[data->items_count++] = item;
+    if (data->titles && item->title && !eina_hash_find(data->titles, item->title))
+        eina_hash_add(data->titles, item->title, item);
+    echart_generation_bump(&data->generation, ECHART_CHANGE_DATA);
+}
+
+EAPI unsigned int
+echart_data_items_count(const Echart_Data *data)
+{
+    if (!data)
+        return 0;
+
+    return data->items_count;
+}
+
+EAPI const Echart_Data_Item *
+echart_data_items_get(const Echart_Data *data, int idx)
+{
+    if (!data || (idx < 0) || ((unsigned int)idx >= data->items_count))
+        return NULL;
+
+    return data->items[idx];
+}
+
+/*
+ * The first item with that title, the titles of the items being those
+ * they had when they have been set to the data.
+ */
+EAPI const Echart_Data_Item *
+echart_data_items_find(const Echart_Data *data, const char *title)
+{
+    Echart_Data *d;
+    unsigned int i;
+
+    if (!data || !title)
+        return NULL;
+
+    if (!data->titles)
+    {
+        d = (Echart_Data *)data;
+        d->titles = eina_hash_string_superfast_new(NULL);
+        if (!d->titles)
+            return NULL;
+
+        for (i = 0; i < data->items_count; i++)
+        {
+            if (data->items[i]->title && !eina_hash_find(data->titles, data->items[i]->title))
+                eina_hash_add(d->titles, data->items[i]->title, data->items[i]);
+        }
+    }
+
+    return eina_hash_find(data->titles, title);
+}
+
+EAPI void
+echart_data_ring_set(Echart_Data *data, unsigned int capacity)
+{
+    unsigned int i;
+
+    if (!data)
+        return;
+
+    echart_data_item_ring_set(data->absciss, capacity);
+    for (i = 0; i < data->items_count; i++)
+        echart_data_item_ring_set(data->items[i], capacity);
+}
+
+EAPI void
+echart_data_values_push(Echart_Data *data, double absciss, const double *values)
+{
+    unsigned int i;
+
+    if (!data || !data->absciss || (data->items_count && !values))
+        return;
+
+    /* the absciss and the items advance in lockstep */
+    echart_data_item_value_add(data->absciss, absciss);
+    for (i = 0; i < data->items_count; i++)
+        echart_data_item_value_add(data->items[i], values[i]);
+}
+
+EAPI unsigned int
+echart_data_generation_get(const Echart_Data *data)
+{
+    if (!data)
+        return 0;
+
+    return data->generation.current;
+}
+
+/*
+ * The changes of the data since the given generation: its title, its
+ * absciss or its items. The values of the items are tracked by the items.
+ */
+EAPI Echart_Change
+echart_data_changes_get(const Echart_Data *data, unsigned int generation)
+{
+    if (!data)
+        return ECHART_CHANGE_NONE;
+
+    return echart_generation_changes_get(&data->generation, generation);
+}
+
+/*
+ * In shared mode, a single writer thread appends values to the absciss and
+ * the items while other threads render snapshots of the data. The absciss,
+ * the items, their style and their level of detail must be set before, and
+ * the values can only be appended, neither bound nor stored in a ring or
+ * compressed. Leaving the shared mode requires that no snapshot is left. On
+ * failure, the data is left in its current mode.
+ */
+EAPI void
+echart_data_shared_set(Echart_Data *data, Eina_Bool shared)
+{
+    Echart_Shared *s;
+    void **mems;
+    unsigned int i;
+
+    if (!data || !data->absciss || (!!data->shared == !!shared))
+        return;
+
+    if (!shared)
+    {
+        if (echart_shared_readers_get(data->shared))
+        {
+            ERR("Can not leave the shared mode while snapshots are alive");
+            return;
+        }
+    }
+    else
+    {
+        if (data->absciss->values_bound || data->absciss->values_ring || data->absciss->codec)
+        {
+            ERR("Can not share a bound, ring or compressed absciss");
+            return;
+        }
+        for (i = 0; i < data->items_count; i++)
+        {
+            if (data->items[i]->values_bound || data->items[i]->values_ring || data->items[i]->codec)
+            {
+                ERR("Can not share a bound, ring or compressed item");
+                return;
+            }
+        }
+    }
+
+    /*
+     * the memory of the absciss, at index 0, and of the items is allocated
+     * first, so that the data is left unchanged on failure
+     */
+    mems = (void **)malloc((data->items_count + 1) * sizeof(void *));
+    if (!mems)
+    {
+        ERR("Could not allocate memory to change the shared mode");
+        return;
+    }
+
+    for (i = 0; i <= data->items_count; i++)
+    {
+        mems[i] = _echart_data_item_shared_alloc(i ? data->items[i - 1] : data->absciss, shared);
+        if (!mems[i])
+        {
+            ERR("Could not allocate memory to change the shared mode");
+            while (i--)
+            {
+                if (shared)
+                    echart_shared_buffer_free((Echart_Shared_Buffer *)mems[i]);
+                else
+                    free(mems[i]);
+            }
+            free(mems);
+            return;
+        }
+    }
+
+    if (shared)
+    {
+        s = echart_shared_new();
+        if (!s)
+        {
+            ERR("Could not create the epochs of the data");
+            for (i = 0; i <= data->items_count; i++)
+                echart_shared_buffer_free((Echart_Shared_Buffer *)mems[i]);
+            free(mems);
+            return;
+        }
+    }
+    else
+        s = NULL;
+
+    for (i = 0; i <= data->items_count; i++)
+        _echart_data_item_shared_set(i ? data->items[i - 1] : data->absciss, s, mems[i]);
+    free(mems);
+
+    /* the buffers retired by the writer are freed with the epochs */
+    if (!shared)
+        echart_shared_free(data->shared);
+    data->shared = s;
+}
+
+EAPI Eina_Bool
+echart_data_shared_get(const Echart_Data *data)
+{
+    if (!data)
+        return EINA_FALSE;
+
+    return !!data->shared;
+}
+
+/*
+ * An immutable view of the values published so far by the writer of a
+ * shared data, which can be set to a chart and rendered without blocking
+ * the writer. The memory of the values is kept while the snapshot is
+ * alive, it must be freed with echart_data_free() before data. The items
+ * of a snapshot read the level of detail of the items of data, up to the
+ * values they hold, the pyramids are not rebuilt.
+ */
+EAPI Echart_Data *
+echart_data_snapshot_new(const Echart_Data *data)
+{
+    const Echart_Shared_Buffer **buffers;
+    Echart_Data *snapshot;
+    Echart_Data_Item *item;
+    unsigned int count;
+    unsigned int c;
+    unsigned int i;
+
+    if (!data || !data->shared)
+        return NULL;
+
+    buffers = (const Echart_Shared_Buffer **)malloc((data->items_count + 1) * sizeof(Echart_Shared_Buffer *));
+    if (!buffers)
+        return NULL;
+
+    snapshot = echart_data_new();
+    if (!snapshot)
+    {
+        free(buffers);
+        return NULL;
+    }
+
+    snapshot->snapshot = data->shared;
+    snapshot->snapshot_slot = echart_shared_read_lock(data->shared);
+
+    /*
+     * the writer may be between the absciss and the items of a row, so only
+     * the rows published for all of them are kept
+     */
+    buffers[0] = echart_shared_buffer_get(&data->absciss->shared_buffer);
+    count = echart_shared_buffer_count_get(buffers[0]);
+    for (i = 0; i < data->items_count; i++)
+    {
+        buffers[i + 1] = echart_shared_buffer_get(&data->items[i]->shared_buffer);
+        c = echart_shared_buffer_count_get(buffers[i + 1]);
+        if (c < count)
+            count = c;
+    }
+
+    if (data->title)
+        echart_data_title_set(snapshot, data->title);
+
+    item = _echart_data_item_snapshot_new(data->absciss, buffers[0], count);
+    if (!item)
+        goto free_snapshot;
+    echart_data_absciss_set(snapshot, item);
+
+    for (i = 0; i < data->items_count; i++)
+    {
+        item = _echart_data_item_snapshot_new(data->items[i], buffers[i + 1], count);
+        if (!item)
+            goto free_snapshot;
+        echart_data_items_set(snapshot, item);
+        if (snapshot->items_count != i + 1)
+        {
+            echart_data_item_free(item);
+            goto free_snapshot;
+        }
+        item->color = data->items[i]->color;
+    }
+    free(buffers);
+
+    return snapshot;
+
+  free_snapshot:
+    ERR("Could not create the snapshot of the data");
+    echart_data_free(snapshot);
+    free(buffers);
+    return NULL;
+}
+
+EAPI Echart_Data_Item *
+echart_data_item_new(void)
+{
+    return echart_data_item_new_typed(ECHART_VALUE_TYPE_DOUBLE);
+}
+
+/*
+ * The values added to the item are converted to type and stored natively.
+ * Except in ring mode, where doubles are stored. For the integer types, the
+ * values are rounded to the nearest integer and saturated to the range of
+ * the type, NaN being stored as 0.
+ */
+EAPI Echart_Data_Item *
+echart_data_item_new_typed(Echart_Value_Type type)
+{
+    Echart_Data_Item *item;
+
+    if (!_echart_value_type_size(type))
+    {
+        ERR("Unknown value type %d", type);
+        return NULL;
+    }
+
+    item = (Echart_Data_Item *)calloc(1, sizeof(Echart_Data_Item));
+    if (!item)
+        return NULL;
+
+    item->type = type;
+    item->values_stride = _echart_value_type_size(type);
+    item->values_type = type;
+    echart_generation_init(&item->generation);
+
+    return item;
+}
+
+/*
+ * The item, its title and its values are allocated in the arena of data and
+ * released with it, with the memory it allocates outside of the arena, even
+ * if it is never set to data. If data has no arena, it is a usual item.
+ */
+EAPI Echart_Data_Item *
+echart_data_item_new_arena(Echart_Data *data, Echart_Value_Type type)
+{
+    Echart_Data_Item *item;
+
+    if (!data)
+        return NULL;
+
+    if (!data->arena)
+        return echart_data_item_new_typed(type);
+
+    if (!_echart_value_type_size(type))
+    {
+        ERR("Unknown value type %d", type);
+        return NULL;
+    }
+
+    item = (Echart_Data_Item *)echart_arena_alloc(data->arena, sizeof(Echart_Data_Item));
+    if (!item)
+        return NULL;
+
+    item->arena = data->arena;
+    item->arena_next = data->arena_items;
+    data->arena_items = item;
+    item->type = type;
+    item->values_stride = _echart_value_type_size(type);
+    item->values_type = type;
+    echart_generation_init(&item->generation);
+
+    return item;
+}
+
+EAPI void
+echart_data_item_free(Echart_Data_Item *item)
+{
+    if (!item)
+        return;
+
+    /*
+     * only the memory outside of the arena is released for arena items,
+     * which stay valid until their data is freed, so that it can be done
+     * again then
+     */
+    if (item->title && !item->arena)
+        free(item->title);
+    _echart_data_item_values_release(item);
+    echart_lod_free(item->lod);
+    eina_list_free(item->values_list);
+    free(item->values_shadow);
+    if (!item->arena)
+    {
+        free(item);
+        return;
+    }
 
-    return stacked;
-
-  free_data:
-    echart_data_free(stacked);
-    return NULL;
+    item->lod = NULL;
+    item->values_list = NULL;
+    item->values_shadow = NULL;
 }
 
-/*============================================================================*
- *                                   API                                      *
- *============================================================================*/
-
-EAPI Echart_Data *
-echart_data_new(void)
+EAPI void
+echart_data_item_title_set(Echart_Data_Item *item, const char *title)
 {
-    Echart_Data *data;
+    if (!item || !title || !*title)
+        return;
 
-    data = (Echart_Data *)calloc(1, sizeof(Echart_Data));
-    if (!data)
+    if (item->arena)
+        item->title = echart_arena_strdup(item->arena, title);
+    else
+        item->title = strdup(title);
+    echart_generation_bump(&item->generation, ECHART_CHANGE_STYLE);
+}
+
+EAPI const char *
+echart_data_item_title_get(const Echart_Data_Item *item)
+{
+    if (!item)
         return NULL;
 
-    return data;
+    return item->title;
 }
 
 EAPI void
-echart_data_free(Echart_Data *data)
+echart_data_item_color_set(Echart_Data_Item *item, uint8_t a, uint8_t r, uint8_t g, uint8_t b)
 {
-    if (!data)
+    if (!item)
         return;
 
-    if (data->title)
-        free(data->title);
-    free(data);
+    enesim_argb_components_from(&item->color.line, a, r, g, b);
+    echart_generation_bump(&item->generation, ECHART_CHANGE_STYLE);
 }
 
-EAPI void
-echart_data_title_set(Echart_Data *data, const char *title)
+EAPI Echart_Colors
+echart_data_item_color_get(const Echart_Data_Item *item)
 {
-    if (!data || !title || !*title)
-        return;
+    Echart_Colors black = { 0xff000000, 0xff000000 };
+
+    if (!item)
+        return black;
 
-    data->title = strdup(title);
+    return item->color;
 }
 
-EAPI const char *
-echart_data_title_get(const Echart_Data *data)
+EAPI void
+echart_data_item_value_add(Echart_Data_Item *item, double value)
 {
-    if (!data)
-        return NULL;
-
-    return data->title;
+    echart_data_item_values_add(item, &value, 1);
 }
 
 EAPI void
-echart_data_absciss_set(Echart_Data *data, const Echart_Data_Item *absciss)
+echart_data_item_values_add(Echart_Data_Item *item, const double *values, size_t count)
 {
-    unsigned int count;
+    double vmin;
+    double vmax;
+    size_t i;
 
-    if (!data || !absciss)
+    if (!item || !values || !count)
         return;
 
-    data->absciss = (Echart_Data_Item *)absciss;
+    if (item->values_bound)
+    {
+        ERR("Can not add values to an item bound to an external buffer");
+        return;
+    }
+
+    if (item->values_ring)
+    {
+        for (i = 0; i < count; i++)
+            _echart_data_item_ring_push(item, values[i]);
+        item->values_list_dirty = 1;
+        _echart_data_item_lod_update(item);
+        echart_generation_bump(&item->generation, ECHART_CHANGE_VALUES);
+        return;
+    }
+
+    if (item->codec)
+    {
+        if (!echart_codec_append(item->codec, values, count))
+            ERR("Could not allocate memory to compress %u values", (unsigned int)count);
+        item->values_count = echart_codec_count(item->codec);
+        if (item->values_count)
+            echart_codec_interval_get(item->codec, 0, item->values_count, &item->vmin, &item->vmax);
+        item->interval_dirty = 0;
+        item->values_list_dirty = 1;
+        _echart_data_item_lod_update(item);
+        echart_generation_bump(&item->generation, ECHART_CHANGE_VALUES);
+        return;
+    }
+
+    if (!_echart_data_item_values_grow(item, count))
+    {
+        ERR("Could not allocate memory for %u values", (unsigned int)count);
+        return;
+    }
+
+    /* the interval of the values as stored, after their conversion */
+    _echart_data_item_values_store(item, item->values_count, values, count);
+    echart_simd_interval_typed_get(item->values + item->values_count * item->values_stride,
+                                   item->values_type, count, &vmin, &vmax);
+    if (item->values_count)
+    {
+        _echart_data_item_interval_update(item);
+        if (item->vmin < vmin) vmin = item->vmin;
+        if (item->vmax > vmax) vmax = item->vmax;
+    }
+
+    item->values_count += count;
+    item->vmin = vmin;
+    item->vmax = vmax;
+    item->interval_dirty = 0;
+    item->values_list_dirty = 1;
+    if (item->shared)
+    {
+        echart_shared_buffer_publish(item->shared_buffer, item->values_count);
+        echart_shared_reclaim(item->shared);
+    }
+    _echart_data_item_lod_update(item);
+    echart_generation_bump(&item->generation, ECHART_CHANGE_VALUES);
 }
 
-EAPI const Echart_Data_Item *
-echart_data_absciss_get(const Echart_Data *data)
+EAPI void
+echart_data_item_values_bind(Echart_Data_Item *item, const void *values, size_t count, size_t stride, Echart_Value_Type type, Eina_Free_Cb free_cb)
 {
-    if (!data)
-        return NULL;
+    size_t size;
 
-    return data->absciss;
+    if (!item || !values)
+        return;
+
+    if (item->shared)
+    {
+        ERR("Can not bind the values of a shared item");
+        return;
+    }
+
+    size = _echart_value_type_size(type);
+    if (!size)
+    {
+        ERR("Unknown value type %d", type);
+        return;
+    }
+
+    /* binding again the same buffer, for example to extend the view */
+    if (item->values_bound && (item->values == (const unsigned char *)values))
+        item->values_free_cb = NULL;
+    _echart_data_item_values_release(item);
+
+    item->values = (unsigned char *)values;
+    item->values_stride = stride ? stride : size;
+    item->values_type = type;
+    item->values_count = count;
+    item->values_free_cb = free_cb;
+    item->values_bound = 1;
+    /* vmin and vmax are computed on first use */
+    item->interval_dirty = 1;
 }
 
 EAPI void
-echart_data_items_set(Echart_Data *data, Echart_Data_Item *item)
+echart_data_item_ring_set(Echart_Data_Item *item, unsigned int capacity)
 {
+    double *kept;
     unsigned int count;
+    unsigned int first;
+    unsigned int i;
 
-    if (!data || !item)
+    if (!item)
         return;
 
-    count = eina_list_count(data->items);
-    if (count == 20)
+    if (item->values_bound)
     {
-        WRN("Maximum items count reached");
+        ERR("Can not set the ring mode of an item bound to an external buffer");
         return;
     }
 
-    if (eina_list_count(data->absciss->values) != eina_list_count(item->values))
+    if (!item->values_ring && !capacity)
+        return;
+
+    if (item->shared)
     {
-        WRN("Adding an item with different values count");
+        ERR("Can not set the ring mode of a shared item");
+        return;
+    }
+
+    if (item->codec)
+    {
+        ERR("Can not set the ring mode of a compressed item");
+        return;
+    }
+
+    /* keep the most recent values that fit in the new capacity */
+    count = item->values_count;
+    if (capacity && (count > capacity))
+        count = capacity;
+    first = item->values_count - count;
+
+    kept = NULL;
+    if (count)
+    {
+        kept = (double *)malloc(count * sizeof(double));
+        if (!kept)
+        {
+            ERR("Could not allocate memory for %u values", count);
+            return;
+        }
+        echart_data_item_values_transform(item, first, count, 0.0, 1.0, kept);
+    }
+
+    _echart_data_item_values_release(item);
+
+    if (!capacity)
+    {
+        /* back to a plain array of the type of the item */
+        if (count)
+            echart_data_item_values_add(item, kept, count);
+        free(kept);
+        return;
+    }
+
+    /* the ring always stores doubles */
+    item->values_stride = sizeof(double);
+    item->values_type = ECHART_VALUE_TYPE_DOUBLE;
+    item->values = (unsigned char *)malloc(capacity * sizeof(double));
+    if (!item->values ||
+        !_echart_deque_init(&item->ring.min, capacity) ||
+        !_echart_deque_init(&item->ring.max, capacity))
+    {
+        ERR("Could not allocate memory for a ring of %u values", capacity);
+        _echart_data_item_values_release(item);
+        free(kept);
         return;
     }
-    item->color = echart_chart_default_colors[count];
-    data->items = eina_list_append(data->items, item);
+
+    item->values_alloc = capacity;
+    item->values_ring = 1;
+    for (i = 0; i < count; i++)
+        _echart_data_item_ring_push(item, kept[i]);
+    free(kept);
 }
 
 EAPI unsigned int
-echart_data_items_count(const Echart_Data *data)
+echart_data_item_ring_get(const Echart_Data_Item *item)
 {
-    if (!data)
+    if (!item || !item->values_ring)
         return 0;
 
-    return eina_list_count(data->items);
+    return item->values_alloc;
 }
 
-EAPI const Echart_Data_Item *
-echart_data_items_get(const Echart_Data *data, int idx)
+/*
+ * The values are stored compressed: with the delta of delta of consecutive
+ * values for the integer types, which suits regular timestamps, and with
+ * the xor of consecutive values for the floating point ones. They are
+ * decoded block-wise when read.
+ */
+EAPI void
+echart_data_item_compressed_set(Echart_Data_Item *item, Eina_Bool compressed)
 {
-    if (!data || (idx < 0) || ((unsigned int)idx >= eina_list_count(data->items)))
-        return NULL;
+    double *kept;
+    unsigned int count;
+
+    if (!item || (!!item->codec == !!compressed))
+        return;
+
+    if (item->values_bound || item->values_ring || item->shared)
+    {
+        ERR("Can not compress the values of a bound, ring or shared item");
+        return;
+    }
+
+    count = item->values_count;
+    kept = NULL;
+    if (count)
+    {
+        kept = (double *)malloc(count * sizeof(double));
+        if (!kept)
+        {
+            ERR("Could not allocate memory for %u values", count);
+            return;
+        }
+        /* a compressed item is decoded block-wise */
+        echart_data_item_values_transform(item, 0, count, 0.0, 1.0, kept);
+    }
+
+    _echart_data_item_values_release(item);
+
+    if (compressed)
+    {
+        item->codec = echart_codec_new(item->type);
+        if (!item->codec)
+            ERR("Could not create the codec of the item");
+    }
+
+    if (count)
+        echart_data_item_values_add(item, kept, count);
+    free(kept);
 
-    return eina_list_nth(data->items, idx);
+    if (item->codec)
+        DBG("%u values compressed in %lu bytes",
+            item->values_count, (unsigned long)echart_codec_size(item->codec));
 }
 
-EAPI Echart_Data_Item *
-echart_data_item_new(void)
+EAPI Eina_Bool
+echart_data_item_compressed_get(const Echart_Data_Item *item)
 {
-    Echart_Data_Item *item;
-
-    item = (Echart_Data_Item *)calloc(1, sizeof(Echart_Data_Item));
     if (!item)
-        return NULL;
+        return EINA_FALSE;
 
-    return item;
+    return !!item->codec;
 }
 
 EAPI void
-echart_data_item_free(Echart_Data_Item *item)
+echart_data_item_lod_set(Echart_Data_Item *item, Eina_Bool lod)
 {
-    if (!item)
+    if (!item || (!!item->lod == !!lod))
         return;
 
-    if (item->title)
-        free(item->title);
-    free(item);
+    /* the readers of a shared item may read its pyramid */
+    if (item->shared)
+    {
+        ERR("Can not change the level of detail of a shared item");
+        return;
+    }
+
+    if (!lod)
+    {
+        echart_lod_free(item->lod);
+        item->lod = NULL;
+        return;
+    }
+
+    item->lod = echart_lod_new();
+    if (!item->lod)
+    {
+        ERR("Could not create the level of detail of the item");
+        return;
+    }
+    item->lod_reset = item->values_reset;
+    item->lod_first = item->ring.first;
+    _echart_data_item_lod_update(item);
 }
 
-EAPI void
-echart_data_item_title_set(Echart_Data_Item *item, const char *title)
+EAPI Eina_Bool
+echart_data_item_lod_get(const Echart_Data_Item *item)
 {
-    if (!item || !title || !*title)
-        return;
+    if (!item)
+        return EINA_FALSE;
 
-    item->title = strdup(title);
+    return !!item->lod;
 }
 
-EAPI const char *
-echart_data_item_title_get(const Echart_Data_Item *item)
+/*
+ * A value of a compressed item is decoded from the start of its block of
+ * 1024 values, so reading all the values one by one is slow.
+ */
+EAPI double
+echart_data_item_value_get(const Echart_Data_Item *item, unsigned int idx)
+{
+    if (!item || (idx >= item->values_count))
+        return 0.0;
+
+    return _echart_data_item_value(item, idx);
+}
+
+EAPI unsigned int
+echart_data_item_values_count(const Echart_Data_Item *item)
 {
     if (!item)
-        return NULL;
+        return 0;
 
-    return item->title;
+    return item->values_count;
 }
 
-EAPI void
-echart_data_item_color_set(Echart_Data_Item *item, uint8_t a, uint8_t r, uint8_t g, uint8_t b)
+EAPI const double *
+echart_data_item_values_array_get(const Echart_Data_Item *item)
 {
     if (!item)
-        return;
+        return NULL;
 
-    enesim_argb_components_from(&item->color.line, a, r, g, b);
+    if (item->values_ring || item->codec ||
+        (item->values_type != ECHART_VALUE_TYPE_DOUBLE) ||
+        (item->values_stride != sizeof(double)))
+        return NULL;
+
+    return (const double *)item->values;
 }
 
-EAPI Echart_Colors
-echart_data_item_color_get(const Echart_Data_Item *item)
+EAPI const Eina_List *
+echart_data_item_values_get(const Echart_Data_Item *item)
 {
-    Echart_Colors black = { 0xff000000, 0xff000000 };
+    Echart_Data_Item *it;
+    const double *values;
+    unsigned int i;
 
     if (!item)
-        return black;
+        return NULL;
 
-    return item->color;
+    /*
+     * values are stored in a contiguous array, the list is only built on
+     * demand for the callers that still need it. It is rebuilt when values
+     * have been added since, as the array may have been moved.
+     */
+    if (!item->values_list_dirty)
+        return item->values_list;
+
+    it = (Echart_Data_Item *)item;
+    it->values_list = eina_list_free(it->values_list);
+    free(it->values_shadow);
+    it->values_shadow = NULL;
+
+    values = echart_data_item_values_array_get(it);
+    if (!values && it->values_count)
+    {
+        /* bound values which are not plain doubles */
+        it->values_shadow = (double *)malloc(it->values_count * sizeof(double));
+        if (!it->values_shadow)
+            return NULL;
+        echart_data_item_values_transform(it, 0, it->values_count, 0.0, 1.0, it->values_shadow);
+        values = it->values_shadow;
+    }
+
+    for (i = 0; i < it->values_count; i++)
+        it->values_list = eina_list_append(it->values_list, values + i);
+    it->values_list_dirty = 0;
+
+    return it->values_list;
 }
 
 EAPI void
-echart_data_item_value_add(Echart_Data_Item *item, double value)
+echart_data_item_interval_get(const Echart_Data_Item *item, double *vmin, double *vmax)
 {
-    double *v;
-
     if (!item)
+    {
+        if (vmin) *vmin = 0.0;
+        if (vmax) *vmax = 0.0;
         return;
+    }
 
-    v = (double *)malloc(sizeof(double));
-    if (!v)
-        return;
+    _echart_data_item_interval_update((Echart_Data_Item *)item);
+
+    if (vmin) *vmin = item->vmin;
+    if (vmax) *vmax = item->vmax;
+}
 
-    *v = value;
+/*
+ * The interval of the values of index in [i0, i1). When the level of detail
+ * is enabled, the pyramid is used as a range index and only the samples of
+ * the partial buckets on both sides of the range are read. Otherwise, all
+ * the values of the range are read, which the line drawer does again for
+ * each series every time the viewport changes: enable the level of detail
+ * with echart_data_item_lod_set() on the items of charts that are panned
+ * or zoomed.
+ */
+EAPI Eina_Bool
+echart_data_item_range_interval_get(const Echart_Data_Item *item, unsigned int i0, unsigned int i1, double *vmin, double *vmax)
+{
+    unsigned int mask;
+    unsigned int a;
+    unsigned int b;
+    double min;
+    double max;
+    double lmin;
+    double lmax;
 
-    item->values = eina_list_append(item->values, v);
-    if (eina_list_count(item->values) == 1)
+    lmin = 0.0;
+    lmax = 0.0;
+    if (!item || (i0 >= i1) || (i1 > item->values_count))
     {
-        item->vmin = value;
-        item->vmax = value;
+        if (vmin) *vmin = 0.0;
+        if (vmax) *vmax = 0.0;
+        return EINA_FALSE;
     }
-    else
+
+    if ((i0 == 0) && (i1 == item->values_count))
     {
-        if (value < item->vmin) item->vmin = value;
-        if (value > item->vmax) item->vmax = value;
+        echart_data_item_interval_get(item, vmin, vmax);
+        return EINA_TRUE;
     }
+
+    /* the part of the range aligned on the buckets, covered by the pyramid */
+    mask = (1U << ECHART_LOD_SHIFT) - 1;
+    a = i1;
+    b = i1;
+    _echart_data_item_lod_update((Echart_Data_Item *)item);
+    if (item->lod)
+    {
+        unsigned int offset;
+        unsigned int p0;
+        unsigned int p1;
+
+        offset = _echart_data_item_lod_offset(item);
+        p0 = (i0 + offset + mask) & ~mask;
+        p1 = (i1 + offset) & ~mask;
+        if ((p0 < p1) && echart_lod_interval_get(item->lod, p0, p1, &lmin, &lmax))
+        {
+            a = p0 - offset;
+            b = p1 - offset;
+        }
+    }
+
+    if (a < b)
+    {
+        min = lmin;
+        max = lmax;
+        if (i0 < a)
+        {
+            _echart_data_item_values_interval(item, i0, a, &lmin, &lmax);
+            if (lmin < min) min = lmin;
+            if (lmax > max) max = lmax;
+        }
+        if (b < i1)
+        {
+            _echart_data_item_values_interval(item, b, i1, &lmin, &lmax);
+            if (lmin < min) min = lmin;
+            if (lmax > max) max = lmax;
+        }
+    }
+    else
+        _echart_data_item_values_interval(item, i0, i1, &min, &max);
+
+    if (vmin) *vmin = min;
+    if (vmax) *vmax = max;
+
+    return EINA_TRUE;
 }
 
-EAPI const Eina_List *
-echart_data_item_values_get(const Echart_Data_Item *item)
+EAPI unsigned int
+echart_data_item_generation_get(const Echart_Data_Item *item)
 {
     if (!item)
-        return NULL;
+        return 0;
 
-    return item->values;
+    return item->generation.current;
 }
 
-EAPI void
-echart_data_item_interval_get(const Echart_Data_Item *item, double *vmin, double *vmax)
+/*
+ * The changes of the item since the given generation, at which the caller
+ * has seen count values. The values of index in [first, first + nbr) must
+ * be recomputed: the appended ones, or all of them when the stored values
+ * have been changed, or moved to lower indices by the evictions of a full
+ * ring (ECHART_CHANGE_SHIFT).
+ */
+EAPI Echart_Change
+echart_data_item_changes_get(const Echart_Data_Item *item, unsigned int generation, unsigned int count,
+                             unsigned int *first, unsigned int *nbr)
 {
+    Echart_Change change;
+
     if (!item)
     {
-        if (vmin) *vmin = 0.0;
-        if (vmax) *vmax = 0.0;
+        if (first) *first = 0;
+        if (nbr) *nbr = 0;
+        return ECHART_CHANGE_NONE;
     }
 
-    if (vmin) *vmin = item->vmin;
-    if (vmax) *vmax = item->vmax;
+    change = echart_generation_changes_get(&item->generation, generation);
+    if (count > item->values_count)
+        change |= ECHART_CHANGE_RESET;
+
+    if (change & (ECHART_CHANGE_RESET | ECHART_CHANGE_SHIFT))
+        count = 0;
+    else if (!(change & ECHART_CHANGE_VALUES))
+        count = item->values_count;
+
+    if (first) *first = count;
+    if (nbr) *nbr = item->values_count - count;
+
+    return change;
 }
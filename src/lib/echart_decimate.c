@@ -0,0 +1,370 @@
+/* Echart - Chart rendering library
+ * Copyright (C) 2013 Vincent Torri
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <Enesim.h>
+#include <math.h>
+
+#include "Echart.h"
+#include "echart_private.h"
+
+/*============================================================================*
+ *                                  Local                                     *
+ *============================================================================*/
+
+/**
+ * @cond LOCAL
+ */
+
+/* the samples of a series, read by blocks */
+typedef struct _Echart_Decimate_Source Echart_Decimate_Source;
+
+struct _Echart_Decimate_Source
+{
+    const Echart_Data_Item *absciss;
+    const Echart_Data_Item *item;
+    /* the stacked values of the series, read instead of those of item */
+    const double *stacked;
+    unsigned int first;
+    Echart_Buffer *xbuffer;
+    Echart_Buffer *ybuffer;
+};
+
+/*
+ * the samples of index in [start, start + count) of the series, in a block
+ * given by echart_data_fetch_count(), so that a compressed item is decoded
+ * one block at a time
+ */
+static Eina_Bool
+_echart_decimate_block_get(Echart_Decimate_Source *src, unsigned int start, unsigned int count,
+                           const double **x, const double **y)
+{
+    *x = echart_data_item_values_fetch(src->absciss, src->first + start, count, src->xbuffer);
+    if (src->stacked)
+        *y = src->stacked + start;
+    else
+        *y = echart_data_item_values_fetch(src->item, src->first + start, count, src->ybuffer);
+
+    return *x && *y;
+}
+
+/* the samples kept for a run of samples in the same column, in order */
+static Eina_Bool
+_echart_decimate_minmax_run_add(unsigned int ifirst, unsigned int imin, unsigned int imax,
+                                unsigned int ilast, unsigned int *indices, unsigned int size,
+                                unsigned int *n)
+{
+    unsigned int kept[4];
+    unsigned int k;
+
+    if (*n + 4 > size)
+        return EINA_FALSE;
+
+    kept[0] = ifirst;
+    kept[1] = (imin < imax) ? imin : imax;
+    kept[2] = (imin < imax) ? imax : imin;
+    kept[3] = ilast;
+    for (k = 0; k < 4; k++)
+    {
+        if (!*n || (indices[*n - 1] != kept[k]))
+            indices[(*n)++] = kept[k];
+    }
+
+    return EINA_TRUE;
+}
+
+/*
+ * For each run of consecutive samples falling in the same pixel column, keep
+ * the first, the last, the lowest and the highest ones, in their original
+ * order. A polyline through these points reaches the same rows as the
+ * polyline through all the samples of the run in each column and joins the
+ * columns the same way, but it is not identical: inside a column, the
+ * segments between the dropped samples are gone, so the coverage of the
+ * antialiased pixels along them can differ. Use ECHART_DECIMATION_NONE for
+ * an exact rendering. The samples are read block by block, a run going on
+ * from a block to the next one. Returns 0 if size is too small, which only
+ * happens when the absciss is not sorted.
+ */
+static unsigned int
+_echart_decimate_minmax(Echart_Decimate_Source *src, unsigned int count,
+                        double x_offset, double x_scale,
+                        unsigned int *indices, unsigned int size)
+{
+    const double *x;
+    const double *y;
+    Eina_Bool run;
+    unsigned int ifirst;
+    unsigned int imin;
+    unsigned int imax;
+    unsigned int ilast;
+    unsigned int start;
+    unsigned int nbr;
+    unsigned int n;
+    double ymin;
+    double ymax;
+    double col;
+
+    n = 0;
+    run = EINA_FALSE;
+    ifirst = imin = imax = ilast = 0;
+    ymin = ymax = col = 0.0;
+    for (start = 0; start < count; start += nbr)
+    {
+        unsigned int j;
+
+        nbr = echart_data_fetch_count(src->first + start, src->first + count);
+        if (!_echart_decimate_block_get(src, start, nbr, &x, &y))
+            return 0;
+
+        for (j = 0; j < nbr; j++)
+        {
+            double c;
+
+            c = floor(x_offset + x_scale * x[j]);
+            if (!run || (c != col))
+            {
+                if (run && !_echart_decimate_minmax_run_add(ifirst, imin, imax, ilast, indices, size, &n))
+                    return 0;
+
+                run = EINA_TRUE;
+                col = c;
+                ifirst = imin = imax = ilast = start + j;
+                ymin = ymax = y[j];
+                continue;
+            }
+
+            if (y[j] < ymin)
+            {
+                ymin = y[j];
+                imin = start + j;
+            }
+            if (y[j] > ymax)
+            {
+                ymax = y[j];
+                imax = start + j;
+            }
+            ilast = start + j;
+        }
+    }
+
+    if (run && !_echart_decimate_minmax_run_add(ifirst, imin, imax, ilast, indices, size, &n))
+        return 0;
+
+    return n;
+}
+
+/* the mean of the samples of index in [start, end), read block by block */
+static Eina_Bool
+_echart_decimate_mean_get(Echart_Decimate_Source *src, unsigned int start, unsigned int end,
+                          double *x_mean, double *y_mean)
+{
+    const double *x;
+    const double *y;
+    double x_sum;
+    double y_sum;
+    unsigned int nbr;
+    unsigned int i;
+
+    x_sum = 0.0;
+    y_sum = 0.0;
+    for (i = start; i < end; i += nbr)
+    {
+        nbr = echart_data_fetch_count(src->first + i, src->first + end);
+        if (!_echart_decimate_block_get(src, i, nbr, &x, &y))
+            return EINA_FALSE;
+        x_sum += echart_simd_sum(x, nbr);
+        y_sum += echart_simd_sum(y, nbr);
+    }
+
+    *x_mean = x_sum / (end - start);
+    *y_mean = y_sum / (end - start);
+
+    return EINA_TRUE;
+}
+
+/*
+ * Largest Triangle Three Buckets: the samples are split in threshold - 2
+ * buckets and the sample of each bucket forming the largest triangle with
+ * the previously kept sample and the mean of the next bucket is kept. The
+ * buckets are read block by block, each sample being read twice, once for
+ * the mean of its bucket and once to be compared with the others.
+ */
+static unsigned int
+_echart_decimate_lttb(Echart_Decimate_Source *src, unsigned int count,
+                      unsigned int threshold, unsigned int *indices)
+{
+    const double *x;
+    const double *y;
+    double bucket;
+    double xa;
+    double ya;
+    unsigned int nbr;
+    unsigned int n;
+    unsigned int i;
+
+    if ((threshold < 3) || (count <= threshold))
+        return 0;
+
+    if (!_echart_decimate_block_get(src, 0, 1, &x, &y))
+        return 0;
+    xa = x[0];
+    ya = y[0];
+
+    bucket = (double)(count - 2) / (double)(threshold - 2);
+    n = 0;
+    indices[n++] = 0;
+    for (i = 0; i < threshold - 2; i++)
+    {
+        unsigned int start;
+        unsigned int end;
+        unsigned int next_start;
+        unsigned int next_end;
+        unsigned int j;
+        unsigned int kept;
+        double x_mean;
+        double y_mean;
+        double x_kept;
+        double y_kept;
+        double area_max;
+
+        start = (unsigned int)(i * bucket) + 1;
+        end = (unsigned int)((i + 1) * bucket) + 1;
+        next_start = end;
+        next_end = (unsigned int)((i + 2) * bucket) + 1;
+        if (next_end > count)
+            next_end = count;
+
+        if (next_end > next_start)
+        {
+            if (!_echart_decimate_mean_get(src, next_start, next_end, &x_mean, &y_mean))
+                return 0;
+        }
+        else
+        {
+            if (!_echart_decimate_block_get(src, count - 1, 1, &x, &y))
+                return 0;
+            x_mean = x[0];
+            y_mean = y[0];
+        }
+
+        kept = start;
+        x_kept = xa;
+        y_kept = ya;
+        area_max = -1.0;
+        for (j = start; j < end; j += nbr)
+        {
+            unsigned int k;
+
+            nbr = echart_data_fetch_count(src->first + j, src->first + end);
+            if (!_echart_decimate_block_get(src, j, nbr, &x, &y))
+                return 0;
+
+            for (k = 0; k < nbr; k++)
+            {
+                double area;
+
+                area = fabs((xa - x_mean) * (y[k] - ya) -
+                            (xa - x[k]) * (y_mean - ya));
+                if (area > area_max)
+                {
+                    area_max = area;
+                    kept = j + k;
+                    x_kept = x[k];
+                    y_kept = y[k];
+                }
+            }
+        }
+
+        indices[n++] = kept;
+        xa = x_kept;
+        ya = y_kept;
+    }
+    indices[n++] = count - 1;
+
+    return n;
+}
+
+/**
+ * @endcond
+ */
+
+/*============================================================================*
+ *                                 Global                                     *
+ *============================================================================*/
+
+unsigned int
+echart_decimate_size(Echart_Decimation decimation, unsigned int count, unsigned int width)
+{
+    unsigned int size;
+
+    switch (decimation)
+    {
+        case ECHART_DECIMATION_MINMAX:
+            /* at most 4 samples per column, plus the partial border ones */
+            size = 4 * (width + 2);
+            break;
+        case ECHART_DECIMATION_LTTB:
+            size = 2 * width;
+            break;
+        default:
+            return 0;
+    }
+
+    /* no decimation needed */
+    if (size >= count)
+        return 0;
+
+    return size;
+}
+
+/*
+ * the indices, from first, of the samples of index in [first, first + count)
+ * of the series of item, or of its stacked values if they are given, kept
+ * by the decimation. The values are fetched block by block with the
+ * buffers, a compressed item being never decoded as a whole.
+ */
+unsigned int
+echart_decimate(Echart_Decimation decimation,
+                const Echart_Data_Item *absciss, const Echart_Data_Item *item,
+                const double *stacked, unsigned int first, unsigned int count,
+                double x_offset, double x_scale,
+                unsigned int *indices, unsigned int size,
+                Echart_Buffer *xbuffer, Echart_Buffer *ybuffer)
+{
+    Echart_Decimate_Source src;
+
+    src.absciss = absciss;
+    src.item = item;
+    src.stacked = stacked;
+    src.first = first;
+    src.xbuffer = xbuffer;
+    src.ybuffer = ybuffer;
+
+    switch (decimation)
+    {
+        case ECHART_DECIMATION_MINMAX:
+            return _echart_decimate_minmax(&src, count, x_offset, x_scale, indices, size);
+        case ECHART_DECIMATION_LTTB:
+            return _echart_decimate_lttb(&src, count, size, indices);
+        default:
+            return 0;
+    }
+}
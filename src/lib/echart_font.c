@@ -0,0 +1,294 @@
+/* Echart - Chart rendering library
+ * Copyright (C) 2013 Vincent Torri
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <Enesim.h>
+
+#include "Echart.h"
+#include "echart_private.h"
+
+/*============================================================================*
+ *                                  Local                                     *
+ *============================================================================*/
+
+/**
+ * @cond LOCAL
+ */
+
+/*
+ * The fonts are loaded once per family and size, and shared by all the
+ * drawers until the library is shut down. The drawers may run in several
+ * threads, so the cache is locked.
+ */
+static Eina_Lock _echart_font_lock;
+static Enesim_Text_Engine *_echart_font_engine = NULL;
+static Eina_Hash *_echart_font_cache = NULL;
+
+/*
+ * The glyphs of the numeric labels, rasterized once per font side by side
+ * in a surface, so that the labels are drawn by copying pixels instead of
+ * laying out text
+ */
+static Eina_Hash *_echart_font_atlases = NULL;
+
+static void
+_echart_font_free(void *data)
+{
+    enesim_text_font_unref((Enesim_Text_Font *)data);
+}
+
+static void
+_echart_font_atlas_free(void *data)
+{
+    Echart_Font_Atlas *atlas;
+
+    atlas = (Echart_Font_Atlas *)data;
+    if (atlas->surface)
+        enesim_surface_unref(atlas->surface);
+    free(atlas);
+}
+
+static Echart_Font_Atlas *
+_echart_font_atlas_new(Enesim_Text_Font *f)
+{
+    Echart_Font_Atlas *atlas;
+    Enesim_Renderer *r;
+    Enesim_Rectangle geom;
+    Eina_Rectangle rect;
+    void *data;
+    char text[2];
+    int x;
+    int i;
+
+    atlas = (Echart_Font_Atlas *)calloc(1, sizeof(Echart_Font_Atlas));
+    if (!atlas)
+        return NULL;
+
+    r = enesim_renderer_text_span_new();
+    if (!r)
+        goto free_atlas;
+
+    enesim_renderer_color_set(r, 0xff000000);
+    /* the renderer takes a reference */
+    enesim_renderer_text_span_font_set(r, enesim_text_font_ref(f));
+
+    /* the advance of the glyphs first, to get the size of the surface */
+    text[1] = '\0';
+    x = 0;
+    for (i = 0; i < ECHART_FONT_ATLAS_COUNT; i++)
+    {
+        text[0] = ECHART_FONT_ATLAS_GLYPHS[i];
+        enesim_renderer_text_span_text_set(r, text);
+        enesim_renderer_origin_set(r, 0, 0);
+        enesim_renderer_shape_destination_geometry_get(r, &geom);
+        enesim_rectangle_normalize(&geom, &rect);
+        atlas->x[i] = x;
+        atlas->w[i] = rect.x + rect.w;
+        if (atlas->h < rect.y + rect.h)
+            atlas->h = rect.y + rect.h;
+        x += atlas->w[i];
+    }
+
+    if ((x <= 0) || (atlas->h <= 0))
+        goto unref_renderer;
+
+    atlas->surface = enesim_surface_new(ENESIM_FORMAT_ARGB8888, x, atlas->h);
+    if (!atlas->surface)
+        goto unref_renderer;
+
+    /* then each glyph in its cell */
+    for (i = 0; i < ECHART_FONT_ATLAS_COUNT; i++)
+    {
+        eina_rectangle_coords_from(&rect, atlas->x[i], 0, atlas->w[i], atlas->h);
+        text[0] = ECHART_FONT_ATLAS_GLYPHS[i];
+        enesim_renderer_text_span_text_set(r, text);
+        enesim_renderer_origin_set(r, atlas->x[i], 0);
+        enesim_renderer_draw(r, atlas->surface, ENESIM_ROP_FILL, &rect, 0, 0, NULL);
+    }
+
+    if (!enesim_surface_data_get(atlas->surface, &data, &atlas->stride))
+        goto unref_surface;
+    atlas->pixels = (const uint32_t *)data;
+
+    enesim_renderer_unref(r);
+
+    return atlas;
+
+  unref_surface:
+    enesim_surface_unref(atlas->surface);
+  unref_renderer:
+    enesim_renderer_unref(r);
+  free_atlas:
+    free(atlas);
+
+    return NULL;
+}
+
+/* the lock must be taken */
+static Enesim_Text_Font *
+_echart_font_find(const char *family, int size)
+{
+    Enesim_Text_Font *f;
+    char key[256];
+
+    snprintf(key, sizeof(key), "%s:%d", family, size);
+    key[sizeof(key) - 1] = '\0';
+
+    if (!_echart_font_cache)
+    {
+        _echart_font_cache = eina_hash_string_superfast_new(_echart_font_free);
+        if (!_echart_font_cache)
+            return NULL;
+    }
+    else
+    {
+        f = (Enesim_Text_Font *)eina_hash_find(_echart_font_cache, key);
+        if (f)
+            return f;
+    }
+
+    if (!_echart_font_engine)
+    {
+        _echart_font_engine = enesim_text_engine_default_get();
+        if (!_echart_font_engine)
+            return NULL;
+    }
+
+    f = enesim_text_font_new_description_from(_echart_font_engine, family, size);
+    if (!f)
+    {
+        ERR("Could not load the font %s of size %d", family, size);
+        return NULL;
+    }
+
+    if (!eina_hash_add(_echart_font_cache, key, f))
+    {
+        enesim_text_font_unref(f);
+        return NULL;
+    }
+
+    return f;
+}
+
+/**
+ * @endcond
+ */
+
+/*============================================================================*
+ *                                 Global                                     *
+ *============================================================================*/
+
+Eina_Bool
+echart_font_init(void)
+{
+    return eina_lock_new(&_echart_font_lock);
+}
+
+void
+echart_font_shutdown(void)
+{
+    if (_echart_font_atlases)
+    {
+        eina_hash_free(_echart_font_atlases);
+        _echart_font_atlases = NULL;
+    }
+    if (_echart_font_cache)
+    {
+        eina_hash_free(_echart_font_cache);
+        _echart_font_cache = NULL;
+    }
+    if (_echart_font_engine)
+    {
+        enesim_text_engine_unref(_echart_font_engine);
+        _echart_font_engine = NULL;
+    }
+    eina_lock_free(&_echart_font_lock);
+}
+
+/*
+ * The returned font is owned by the cache, a reference must be taken to
+ * keep it or to give it to a renderer.
+ */
+Enesim_Text_Font *
+echart_font_get(const char *family, int size)
+{
+    Enesim_Text_Font *f;
+
+    eina_lock_take(&_echart_font_lock);
+    f = _echart_font_find(family, size);
+    eina_lock_release(&_echart_font_lock);
+
+    return f;
+}
+
+/*
+ * The atlas of the glyphs of the numeric labels for the given font. It is
+ * owned by the cache and never modified once created, so it can be read
+ * from several threads.
+ */
+const Echart_Font_Atlas *
+echart_font_atlas_get(const char *family, int size)
+{
+    Echart_Font_Atlas *atlas;
+    Enesim_Text_Font *f;
+    char key[256];
+
+    snprintf(key, sizeof(key), "%s:%d", family, size);
+    key[sizeof(key) - 1] = '\0';
+
+    eina_lock_take(&_echart_font_lock);
+
+    atlas = NULL;
+    if (!_echart_font_atlases)
+    {
+        _echart_font_atlases = eina_hash_string_superfast_new(_echart_font_atlas_free);
+        if (!_echart_font_atlases)
+            goto release;
+    }
+    else
+    {
+        atlas = (Echart_Font_Atlas *)eina_hash_find(_echart_font_atlases, key);
+        if (atlas)
+            goto release;
+    }
+
+    f = _echart_font_find(family, size);
+    if (!f)
+        goto release;
+
+    atlas = _echart_font_atlas_new(f);
+    if (!atlas)
+    {
+        ERR("Could not create the glyph atlas of the font %s of size %d", family, size);
+        goto release;
+    }
+
+    if (!eina_hash_add(_echart_font_atlases, key, atlas))
+    {
+        _echart_font_atlas_free(atlas);
+        atlas = NULL;
+    }
+
+  release:
+    eina_lock_release(&_echart_font_lock);
+
+    return atlas;
+}
@@ -0,0 +1,131 @@
+/* Echart - Chart rendering library
+ * Copyright (C) 2013 Vincent Torri
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <math.h>
+
+#include <Enesim.h>
+
+#include "Echart.h"
+#include "echart_private.h"
+
+/*============================================================================*
+ *                                  Local                                     *
+ *============================================================================*/
+
+/**
+ * @cond LOCAL
+ */
+
+/* the dashes of the sub grid, along the lines */
+#define ECHART_GRID_DASH_ON 10
+#define ECHART_GRID_DASH_OFF 8
+
+/* the length of [a0, a1] inside [b0, b1] */
+static inline double
+_echart_grid_overlap(double a0, double a1, double b0, double b1)
+{
+    if (a0 < b0)
+        a0 = b0;
+    if (a1 > b1)
+        a1 = b1;
+
+    return (a1 > a0) ? a1 - a0 : 0.0;
+}
+
+/*
+ * The lines of a grid are all horizontal or vertical and one pixel wide,
+ * so the coverage of their pixels is computed directly from their
+ * position, instead of stroking a shape per line. This draws the line at
+ * pos across, from a0 to a1 along, in the coordinates of the surface. The
+ * dashes start at a0, like the ones of a stroked path.
+ */
+static void
+_echart_grid_line_draw(Echart_Canvas *canvas, double pos, double a0, double a1,
+                       Enesim_Color color, Eina_Bool dashed, Eina_Bool vertical)
+{
+    double start;
+    double c;
+    double l;
+    int k;
+    int i;
+    int i0;
+    int i1;
+
+    if (!canvas->pixels)
+        return;
+
+    start = a0;
+    if (a1 < a0)
+    {
+        double tmp;
+
+        tmp = a0;
+        a0 = a1;
+        a1 = tmp;
+    }
+
+    i0 = (int)floor(a0);
+    i1 = (int)ceil(a1);
+
+    /* the line covers at most two pixels across */
+    for (k = (int)floor(pos - 0.5); k <= (int)floor(pos + 0.5); k++)
+    {
+        c = _echart_grid_overlap(pos - 0.5, pos + 0.5, k, k + 1);
+        if (c <= 0.0)
+            continue;
+
+        for (i = i0; i < i1; i++)
+        {
+            if (dashed &&
+                (fmod(fabs(i + 0.5 - start), ECHART_GRID_DASH_ON + ECHART_GRID_DASH_OFF) >= ECHART_GRID_DASH_ON))
+                continue;
+
+            l = _echart_grid_overlap(a0, a1, i, i + 1);
+            if (vertical)
+                echart_canvas_span_blend(canvas, k, i, 1, (uint32_t)(c * l * 256 + 0.5), color);
+            else
+                echart_canvas_span_blend(canvas, i, k, 1, (uint32_t)(c * l * 256 + 0.5), color);
+        }
+    }
+}
+
+/**
+ * @endcond
+ */
+
+/*============================================================================*
+ *                                 Global                                     *
+ *============================================================================*/
+
+/* the vertical line at x from y0 to y1, in the coordinates of the chart */
+void
+echart_grid_vline_add(Echart_Canvas *canvas, double x, double y0, double y1, Enesim_Color color, Eina_Bool dashed)
+{
+    _echart_grid_line_draw(canvas, x - canvas->x, y0 - canvas->y, y1 - canvas->y, color, dashed, EINA_TRUE);
+}
+
+/* the horizontal line at y from x0 to x1, in the coordinates of the chart */
+void
+echart_grid_hline_add(Echart_Canvas *canvas, double y, double x0, double x1, Enesim_Color color, Eina_Bool dashed)
+{
+    _echart_grid_line_draw(canvas, y - canvas->y, x0 - canvas->x, x1 - canvas->x, color, dashed, EINA_FALSE);
+}
@@ -0,0 +1,340 @@
+/* Echart - Chart rendering library
+ * Copyright (C) 2013 Vincent Torri
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <limits.h>
+#include <math.h>
+#include <string.h>
+
+#include <Enesim.h>
+
+#include "Echart.h"
+#include "echart_private.h"
+
+/*============================================================================*
+ *                                  Local                                     *
+ *============================================================================*/
+
+/**
+ * @cond LOCAL
+ */
+
+/* enough for the digits of a 64 bits integer, a sign and a dot */
+#define ECHART_LABEL_TEXT_MAX 32
+
+typedef struct _Echart_Label Echart_Label;
+
+struct _Echart_Label
+{
+    char text[ECHART_LABEL_TEXT_MAX];
+    int x;
+    int y;
+};
+
+/*
+ * All the labels of a chart, drawn by copying the glyphs of the atlas of
+ * their font in a single canvas
+ */
+struct _Echart_Labels
+{
+    const Echart_Font_Atlas *atlas;
+    Echart_Label *labels;
+    unsigned int count;
+    unsigned int alloc;
+    Echart_Canvas canvas;
+};
+
+static const double _echart_label_pow10[] =
+{
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9
+};
+
+static inline int
+_echart_label_glyph_get(char c)
+{
+    switch (c)
+    {
+        case '-':
+            return 10;
+        case '+':
+            return 11;
+        case '.':
+            return 12;
+        case 'e':
+            return 13;
+        case ',':
+            return 14;
+        default:
+            if ((c >= '0') && (c <= '9'))
+                return c - '0';
+            return -1;
+    }
+}
+
+/* copy the glyphs of the label at (x, y) in the canvas */
+static void
+_echart_label_draw(const Echart_Font_Atlas *atlas, const char *text, int x, int y, Echart_Canvas *canvas)
+{
+    const char *iter;
+    int gx;
+    int gw;
+    int g;
+    int i;
+    int j;
+
+    for (iter = text; *iter; iter++)
+    {
+        g = _echart_label_glyph_get(*iter);
+        if (g < 0)
+            continue;
+
+        gx = atlas->x[g];
+        gw = atlas->w[g];
+        for (j = 0; j < atlas->h; j++)
+        {
+            const uint32_t *src;
+
+            src = (const uint32_t *)((const unsigned char *)atlas->pixels + j * atlas->stride) + gx;
+            for (i = 0; i < gw; i++)
+                echart_canvas_span_blend(canvas, x + i, y + j, 1, src[i] ? 256 : 0, src[i]);
+        }
+        x += gw;
+    }
+}
+
+/**
+ * @endcond
+ */
+
+/*============================================================================*
+ *                                 Global                                     *
+ *============================================================================*/
+
+/*
+ * The label of value with the given count of decimals. The value is
+ * rounded to an integer once scaled, its digits being written from the
+ * last one. The values too large for that use the exponent notation.
+ */
+void
+echart_label_format(char *buf, size_t size, double value, int decimals)
+{
+    char tmp[ECHART_LABEL_TEXT_MAX];
+    unsigned long long n;
+    double scaled;
+    size_t len;
+    int neg;
+    int i;
+
+    if (decimals < 0)
+        decimals = 0;
+    if (decimals > 9)
+        decimals = 9;
+
+    scaled = value * _echart_label_pow10[decimals];
+    if (!(fabs(scaled) < 1e18))
+    {
+        snprintf(buf, size, "%.*e", decimals, value);
+        buf[size - 1] = '\0';
+        return;
+    }
+
+    neg = scaled < 0;
+    n = (unsigned long long)(fabs(scaled) + 0.5);
+
+    i = 0;
+    do
+    {
+        tmp[i++] = '0' + (char)(n % 10);
+        n /= 10;
+        if (i == decimals)
+            tmp[i++] = '.';
+    } while (n || (decimals && (i <= decimals + 1)));
+
+    /* no "-0" */
+    if (neg)
+    {
+        int k;
+
+        for (k = 0; k < i; k++)
+        {
+            if ((tmp[k] != '0') && (tmp[k] != '.'))
+                break;
+        }
+        if (k < i)
+            tmp[i++] = '-';
+    }
+
+    len = 0;
+    while ((i > 0) && (len + 1 < size))
+        buf[len++] = tmp[--i];
+    buf[len] = '\0';
+}
+
+/* the width of the label text, summed from the advances of the glyphs */
+int
+echart_label_width_get(const Echart_Font_Atlas *atlas, const char *text)
+{
+    int w;
+    int g;
+
+    w = 0;
+    for (; *text; text++)
+    {
+        g = _echart_label_glyph_get(*text);
+        if (g >= 0)
+            w += atlas->w[g];
+    }
+
+    return w;
+}
+
+Echart_Labels *
+echart_labels_new(const char *family, int size)
+{
+    Echart_Labels *labels;
+
+    labels = (Echart_Labels *)calloc(1, sizeof(Echart_Labels));
+    if (!labels)
+        return NULL;
+
+    if (!echart_canvas_init(&labels->canvas))
+    {
+        free(labels);
+        return NULL;
+    }
+
+    /* without atlas, the labels are just not drawn */
+    labels->atlas = echart_font_atlas_get(family, size);
+
+    return labels;
+}
+
+void
+echart_labels_free(Echart_Labels *labels)
+{
+    if (!labels)
+        return;
+
+    echart_canvas_shutdown(&labels->canvas);
+    free(labels->labels);
+    free(labels);
+}
+
+void
+echart_labels_clear(Echart_Labels *labels)
+{
+    labels->count = 0;
+}
+
+int
+echart_labels_width_get(const Echart_Labels *labels, const char *text)
+{
+    return labels->atlas ? echart_label_width_get(labels->atlas, text) : 0;
+}
+
+int
+echart_labels_height_get(const Echart_Labels *labels)
+{
+    return labels->atlas ? labels->atlas->h : 0;
+}
+
+/* the label text with its top left corner at (x, y) */
+Eina_Bool
+echart_labels_add(Echart_Labels *labels, const char *text, int x, int y)
+{
+    Echart_Label *label;
+
+    if (labels->count == labels->alloc)
+    {
+        Echart_Label *tmp;
+        unsigned int alloc;
+
+        alloc = labels->alloc ? 2 * labels->alloc : 16;
+        tmp = (Echart_Label *)realloc(labels->labels, alloc * sizeof(Echart_Label));
+        if (!tmp)
+            return EINA_FALSE;
+
+        labels->labels = tmp;
+        labels->alloc = alloc;
+    }
+
+    label = labels->labels + labels->count;
+    strncpy(label->text, text, sizeof(label->text));
+    label->text[sizeof(label->text) - 1] = '\0';
+    label->x = x;
+    label->y = y;
+    labels->count++;
+
+    return EINA_TRUE;
+}
+
+/* Draws the labels in a canvas covering their bounding box */
+Eina_Bool
+echart_labels_update(Echart_Labels *labels)
+{
+    unsigned int i;
+    int x0;
+    int y0;
+    int x1;
+    int y1;
+
+    x0 = y0 = x1 = y1 = 0;
+    if (labels->atlas && labels->count)
+    {
+        x0 = y0 = INT_MAX;
+        x1 = y1 = INT_MIN;
+        for (i = 0; i < labels->count; i++)
+        {
+            Echart_Label *label;
+            int w;
+
+            label = labels->labels + i;
+            w = echart_labels_width_get(labels, label->text);
+            if (x0 > label->x)
+                x0 = label->x;
+            if (y0 > label->y)
+                y0 = label->y;
+            if (x1 < label->x + w)
+                x1 = label->x + w;
+            if (y1 < label->y + labels->atlas->h)
+                y1 = label->y + labels->atlas->h;
+        }
+    }
+
+    if (!echart_canvas_begin(&labels->canvas, x0, y0, x1 - x0, y1 - y0))
+        return EINA_FALSE;
+
+    for (i = 0; i < labels->count; i++)
+        _echart_label_draw(labels->atlas, labels->labels[i].text,
+                           labels->labels[i].x - x0, labels->labels[i].y - y0,
+                           &labels->canvas);
+
+    echart_canvas_end(&labels->canvas);
+
+    return EINA_TRUE;
+}
+
+/* the renderer is owned by the labels, a reference must be taken to keep it */
+Enesim_Renderer *
+echart_labels_renderer_get(const Echart_Labels *labels)
+{
+    return labels->canvas.renderer;
+}
@@ -20,6 +20,8 @@
 # include <config.h>
 #endif
 
+#include <math.h>
+
 #include <Enesim.h>
 
 #include "Echart.h"
@@ -33,39 +35,686 @@
  * @cond LOCAL
  */
 
-#define ECHART_RENDERER_LAYER_ADD(c,l,r) \
-do \
-{ \
-    l = enesim_renderer_compound_layer_new(); \
-    enesim_renderer_compound_layer_renderer_set(l, r); \
-    enesim_renderer_compound_layer_rop_set(l, ENESIM_ROP_BLEND); \
-    enesim_renderer_compound_layer_add(c, l); \
-} while (0)
+/* the font of the title and of the labels */
+#define ECHART_LINE_FONT_NAME "arial"
+#define ECHART_LINE_FONT_SIZE 16
+
+/* the minimal space between two labels of the absciss */
+#define ECHART_LINE_LABEL_GAP 8
+
+typedef struct _Echart_Line_Series Echart_Line_Series;
+
+struct _Echart_Line_Series
+{
+    /* generation and count of values of the item when last drawn */
+    unsigned int generation;
+    unsigned int count;
+    /* set once the series has been drawn and its colors set */
+    unsigned int drawn : 1;
+};
 
 struct _Echart_Line
 {
     const Echart_Chart *chart;
+    Echart_Decimation decimation;
+    double stroke_weight;
     unsigned int area : 1;
     unsigned int stacked : 1;
+    /* set when a property of the line changed since the last update */
+    unsigned int dirty : 1;
+    /* retained scene, patched by echart_line_update() */
+    struct
+    {
+        Enesim_Renderer *compound;
+        Enesim_Text_Font *font;
+        Enesim_Renderer *background;
+        Enesim_Renderer *title;
+        Echart_Labels *labels;
+        Echart_Canvas grid;
+        /* the areas of all the series, created when first shown */
+        Echart_Areas *areas;
+        /* the lines of all the series, in a single canvas */
+        Echart_Polylines *lines;
+        Echart_Line_Series *series;
+        unsigned int series_count;
+        /* what the scene has been built from */
+        const Echart_Data *data;
+        unsigned int chart_generation;
+        unsigned int data_generation;
+        unsigned int absciss_generation;
+        unsigned int absciss_count;
+        /* layout */
+        int w;
+        int h;
+        int x_area;
+        int y_area;
+        int w_area;
+        int h_area;
+        double avmin;
+        double avmax;
+        unsigned int afirst;
+        unsigned int acount;
+        unsigned int title_shown : 1;
+        unsigned int layers_dirty : 1;
+    } scene;
 };
 
+/* the compound takes a reference, the scene keeps its own */
+static void
+_echart_line_layer_add(Enesim_Renderer *c, Enesim_Renderer *r, Enesim_Rop rop)
+{
+    Enesim_Renderer_Compound_Layer *l;
+
+    l = enesim_renderer_compound_layer_new();
+    enesim_renderer_compound_layer_renderer_set(l, enesim_renderer_ref(r));
+    enesim_renderer_compound_layer_rop_set(l, rop);
+    enesim_renderer_compound_layer_add(c, l);
+}
+
+/* makes room for count renderers, the new ones being NULL */
 static Enesim_Renderer *
-_echart_line_text_renderer_from_double(Enesim_Text_Font *f, double d)
+_echart_line_text_renderer_new(Enesim_Text_Font *f)
 {
-    char buf[256];
     Enesim_Renderer *r;
 
-    snprintf(buf, sizeof(buf), "%d", (int)d);
-    buf[sizeof(buf) - 1] = '\0';
-
     r = enesim_renderer_text_span_new();
     enesim_renderer_color_set(r, 0xff000000);
-    enesim_renderer_text_span_text_set(r, buf);
-    enesim_renderer_text_span_font_set(r, f);
+    /* the renderer takes a reference */
+    if (f)
+        enesim_renderer_text_span_font_set(r, enesim_text_font_ref(f));
 
     return r;
 }
 
+/* the box of the label text at the bottom of the chart, x being aligned on align * its width */
+static void
+_echart_line_label_rect_get(const Echart_Line *line, const char *text, double x, double align, Eina_Rectangle *rect)
+{
+    int w;
+    int h;
+
+    w = echart_labels_width_get(line->scene.labels, text);
+    h = echart_labels_height_get(line->scene.labels);
+    eina_rectangle_coords_from(rect, x - align * w, line->scene.h - h, w, h);
+}
+
+/* the label of the bound d of the absciss, truncated as an integer */
+static Eina_Bool
+_echart_line_label_bound_add(Echart_Line *line, double d, double x, double align, Eina_Rectangle *rect)
+{
+    char buf[64];
+
+    echart_label_format(buf, sizeof(buf), d < 0 ? ceil(d) : floor(d), 0);
+    _echart_line_label_rect_get(line, buf, x, align, rect);
+
+    return echart_labels_add(line->scene.labels, buf, rect->x, rect->y);
+}
+
+/*
+ * the interval of the values of the series idx of index in [first, first +
+ * count), count being clamped to the values of the series, which can be
+ * shorter than the absciss. In stacked mode, stacked is set to the stacked
+ * values, otherwise to NULL and the values are read from the item. Returns
+ * EINA_FALSE if there is no value to draw.
+ */
+static Eina_Bool
+_echart_line_series_get(const Echart_Line *line, const Echart_Data *data, unsigned int idx,
+                        unsigned int first, unsigned int *count,
+                        const double **stacked, double *vmin, double *vmax)
+{
+    const Echart_Data_Item *item;
+    const double *values;
+    unsigned int n;
+
+    item = echart_data_items_get(data, idx);
+    *stacked = NULL;
+    values = NULL;
+    if (!line->stacked)
+        n = echart_data_item_values_count(item);
+    else
+    {
+        values = echart_data_stacked_values_get(data, idx, &n, vmin, vmax);
+        if (!values)
+            return EINA_FALSE;
+    }
+
+    if (first >= n)
+        return EINA_FALSE;
+    if (*count > n - first)
+        *count = n - first;
+    if (!*count)
+        return EINA_FALSE;
+
+    /* autoscale on the visible values only */
+    if (!line->stacked)
+        return echart_data_item_range_interval_get(item, first, first + *count, vmin, vmax);
+
+    if (*count < n)
+        echart_simd_interval_get(values + first, *count, vmin, vmax);
+
+    *stacked = values + first;
+    return EINA_TRUE;
+}
+
+/*
+ * the device coordinates of the n drawn samples, read from the items in the
+ * type of their values and transformed in one pass: the abscisses are
+ * stored in points, the ordinates in points + n
+ */
+static const double *
+_echart_line_points_get(const Echart_Data_Item *absciss, const Echart_Data_Item *item,
+                        const double *stacked, unsigned int first,
+                        const unsigned int *kept, unsigned int n,
+                        double x_offset, double x_scale,
+                        double y_offset, double y_scale,
+                        Echart_Buffer *buffer)
+{
+    double *points;
+    unsigned int k;
+
+    points = echart_buffer_get(buffer, 2 * n);
+    if (!points)
+        return NULL;
+
+    if (!kept)
+    {
+        echart_data_item_values_transform(absciss, first, n, x_offset, x_scale, points);
+        if (stacked)
+            echart_simd_transform(stacked, n, y_offset, y_scale, points + n);
+        else
+            echart_data_item_values_transform(item, first, n, y_offset, y_scale, points + n);
+        return points;
+    }
+
+    echart_data_item_values_gather(absciss, first, kept, n, points);
+    if (stacked)
+    {
+        for (k = 0; k < n; k++)
+            points[n + k] = stacked[kept[k]];
+    }
+    else
+        echart_data_item_values_gather(item, first, kept, n, points + n);
+
+    echart_simd_transform(points, n, x_offset, x_scale, points);
+    echart_simd_transform(points + n, n, y_offset, y_scale, points + n);
+
+    return points;
+}
+
+/*
+ * selects the samples of a series to draw: the level of detail of the item
+ * is used when it has one, otherwise the series is decimated, which needs
+ * the values as doubles. Returns the number of samples, kept being set to
+ * their indices or to NULL if all the samples are drawn
+ */
+static unsigned int
+_echart_line_samples_get(const Echart_Line *line,
+                         const Echart_Data_Item *absciss, const Echart_Data_Item *item,
+                         const double *stacked, unsigned int first, unsigned int count,
+                         double x_offset, double x_scale, unsigned int width,
+                         unsigned int *indices, unsigned int size,
+                         Echart_Buffer *xbuffer, Echart_Buffer *ybuffer,
+                         const unsigned int **kept)
+{
+    unsigned int n;
+    unsigned int i;
+
+    *kept = NULL;
+    if (!indices || (line->decimation == ECHART_DECIMATION_NONE))
+        return count;
+
+    /* the pyramid is built on the item values, not on the stacked ones */
+    n = 0;
+    if (!stacked)
+    {
+        n = echart_data_item_lod_fetch(item, first, first + count, width, indices, size);
+        for (i = 0; i < n; i++)
+            indices[i] -= first;
+    }
+    if (!n)
+        n = echart_decimate(line->decimation, absciss, item, stacked, first, count,
+                            x_offset, x_scale, indices, size, xbuffer, ybuffer);
+    if (!n)
+        return count;
+
+    *kept = indices;
+    return n;
+}
+
+static Eina_Bool
+_echart_line_scene_new(Echart_Line *line)
+{
+    Enesim_Text_Font *f;
+
+    line->scene.labels = echart_labels_new(ECHART_LINE_FONT_NAME, ECHART_LINE_FONT_SIZE);
+    if (!line->scene.labels)
+        return EINA_FALSE;
+
+    if (!echart_canvas_init(&line->scene.grid))
+        goto free_labels;
+
+    line->scene.lines = echart_polylines_new();
+    if (!line->scene.lines)
+        goto free_grid;
+
+    line->scene.compound = enesim_renderer_compound_new();
+    if (!line->scene.compound)
+        goto free_lines;
+
+    f = echart_font_get(ECHART_LINE_FONT_NAME, ECHART_LINE_FONT_SIZE);
+    if (f)
+        line->scene.font = enesim_text_font_ref(f);
+
+    line->scene.background = enesim_renderer_rectangle_new();
+    enesim_renderer_rectangle_position_set(line->scene.background, 0, 0);
+    enesim_renderer_shape_draw_mode_set(line->scene.background, ENESIM_RENDERER_SHAPE_DRAW_MODE_FILL);
+
+    line->scene.layers_dirty = 1;
+    line->dirty = 1;
+
+    return EINA_TRUE;
+
+  free_lines:
+    echart_polylines_free(line->scene.lines);
+    line->scene.lines = NULL;
+  free_grid:
+    echart_canvas_shutdown(&line->scene.grid);
+  free_labels:
+    echart_labels_free(line->scene.labels);
+    line->scene.labels = NULL;
+
+    return EINA_FALSE;
+}
+
+static void
+_echart_line_scene_free(Echart_Line *line)
+{
+    if (line->scene.compound)
+        enesim_renderer_unref(line->scene.compound);
+    if (line->scene.background)
+        enesim_renderer_unref(line->scene.background);
+    if (line->scene.title)
+        enesim_renderer_unref(line->scene.title);
+    echart_labels_free(line->scene.labels);
+    echart_canvas_shutdown(&line->scene.grid);
+    echart_areas_free(line->scene.areas);
+    echart_polylines_free(line->scene.lines);
+    free(line->scene.series);
+    if (line->scene.font)
+        enesim_text_font_unref(line->scene.font);
+    memset(&line->scene, 0, sizeof(line->scene));
+}
+
+/*
+ * the title and the labels of the visible abscisses, which give the area
+ * left to the plot
+ */
+static Eina_Bool
+_echart_line_frame_update(Echart_Line *line, const Echart_Data *data)
+{
+    Enesim_Rectangle geom;
+    Eina_Rectangle rect_first;
+    Eina_Rectangle rect_last;
+    Eina_Rectangle rect;
+    const char *title;
+    double avmin;
+    double avmax;
+    double tick;
+    double step;
+    unsigned int count;
+    unsigned int i;
+    int decimals;
+    int label_w;
+    int h_title;
+    int x_area;
+    int y_area;
+    int w_area;
+
+    /* title */
+    h_title = 0;
+    title = echart_data_title_get(data);
+    if (title)
+    {
+        if (!line->scene.title)
+        {
+            line->scene.title = _echart_line_text_renderer_new(line->scene.font);
+            if (!line->scene.title)
+                return EINA_FALSE;
+        }
+
+        enesim_renderer_text_span_text_set(line->scene.title, title);
+        enesim_renderer_shape_destination_geometry_get(line->scene.title, &geom);
+        enesim_renderer_origin_set(line->scene.title, (line->scene.w - geom.w) / 2, 0);
+        enesim_rectangle_normalize(&geom, &rect);
+        h_title = rect.h;
+    }
+    if (line->scene.title_shown != !!title)
+    {
+        line->scene.title_shown = !!title;
+        line->scene.layers_dirty = 1;
+    }
+
+    /* abscisses, the bounds first */
+    avmin = line->scene.avmin;
+    avmax = line->scene.avmax;
+    echart_labels_clear(line->scene.labels);
+    if (!_echart_line_label_bound_add(line, avmin, 0, 0.0, &rect_first) ||
+        !_echart_line_label_bound_add(line, avmax, line->scene.w, 1.0, &rect_last))
+        return EINA_FALSE;
+
+    x_area = rect_first.w / 2 + 1;
+    y_area = rect_first.h;
+    if (y_area < rect_last.h)
+        y_area = rect_last.h;
+    w_area = line->scene.w - (rect_first.w + rect_last.w) / 2;
+
+    /*
+     * then "nice" ticks between them, as many as fit in the area when
+     * their labels are as wide as the widest bound, so that their count
+     * depends on the width of the chart, not on the number of abscisses
+     */
+    label_w = rect_first.w;
+    if (label_w < rect_last.w)
+        label_w = rect_last.w;
+    label_w += ECHART_LINE_LABEL_GAP;
+
+    count = 0;
+    tick = 0.0;
+    step = 1.0;
+    if ((w_area > 0) && (avmax > avmin))
+        count = echart_axis_ticks_get(avmin, avmax, w_area / label_w, &tick, &step);
+    decimals = echart_axis_decimals_get(step);
+
+    for (i = 0; i < count; i++, tick += step)
+    {
+        char buf[64];
+
+        /* the bounds are already drawn */
+        if ((tick <= avmin) || (tick >= avmax))
+            continue;
+
+        echart_label_format(buf, sizeof(buf), tick, decimals);
+        _echart_line_label_rect_get(line, buf, x_area + w_area * (tick - avmin) / (avmax - avmin), 0.5, &rect);
+
+        /* the labels which would overlap the bounds are not shown */
+        if ((rect.x < rect_first.x + rect_first.w + ECHART_LINE_LABEL_GAP) ||
+            (rect.x + rect.w + ECHART_LINE_LABEL_GAP > rect_last.x))
+            continue;
+
+        if (!echart_labels_add(line->scene.labels, buf, rect.x, rect.y))
+            return EINA_FALSE;
+    }
+
+    /* all the labels are drawn by a single renderer */
+    if (!echart_labels_update(line->scene.labels))
+        return EINA_FALSE;
+
+    line->scene.x_area = x_area;
+    line->scene.y_area = y_area;
+    line->scene.w_area = w_area;
+    line->scene.h_area = line->scene.h - y_area - h_title;
+
+    return EINA_TRUE;
+}
+
+/*
+ * the grid, the axes and the sub grid, all drawn by a single renderer, so
+ * that their count of lines does not change the cost of the compound
+ */
+static Eina_Bool
+_echart_line_grid_update(Echart_Line *line, const Echart_Chart *chart)
+{
+    Echart_Canvas *grid;
+    Enesim_Color color;
+    unsigned int i;
+    unsigned int j;
+    int grid_x_nbr;
+    int grid_y_nbr;
+    int sub_grid_x_nbr;
+    int sub_grid_y_nbr;
+    int x_area;
+    int y_area;
+    int w_area;
+    int h_area;
+    int h;
+
+    x_area = line->scene.x_area;
+    y_area = line->scene.y_area;
+    w_area = line->scene.w_area;
+    h_area = line->scene.h_area;
+    h = line->scene.h;
+    grid = &line->scene.grid;
+
+    /* the area and the half pixels of the lines on its borders */
+    if (!echart_canvas_begin(grid, x_area - 1, h - h_area - y_area - 1, w_area + 2, h_area + 2))
+        return EINA_FALSE;
+
+    /* grid, the first lines being the axes */
+    echart_chart_grid_nbr_get(chart, &grid_x_nbr, &grid_y_nbr);
+    color = echart_chart_grid_color_get(chart);
+    for (i = 0; i < (unsigned int)grid_x_nbr; i++)
+    {
+        double x;
+
+        x = x_area + (i * w_area) / (double)(grid_x_nbr - 1);
+        echart_grid_vline_add(grid, x, h - y_area, h - h_area - y_area,
+                              (i == 0) ? 0xff000000 : color, EINA_FALSE);
+    }
+
+    for (j = 0; j < (unsigned int)grid_y_nbr; j++)
+    {
+        double y;
+
+        y = h - y_area - (j * h_area) / (double)(grid_y_nbr - 1);
+        echart_grid_hline_add(grid, y, x_area + 1, x_area + w_area,
+                              (j == 0) ? 0xff000000 : color, EINA_FALSE);
+    }
+
+    /* sub grid */
+    echart_chart_sub_grid_nbr_get(chart, &sub_grid_x_nbr, &sub_grid_y_nbr);
+    color = echart_chart_sub_grid_color_get(chart);
+    for (i = 0; i < (unsigned int)grid_x_nbr; i++)
+    {
+        for (j = 1; (int)j < (sub_grid_x_nbr - 1); j++)
+        {
+            double x;
+
+            x = x_area + w_area * (j + i * (sub_grid_x_nbr - 1)) / (double)((grid_x_nbr - 1) * (sub_grid_x_nbr - 1));
+            echart_grid_vline_add(grid, x, h - h_area - y_area + 1, h - y_area, color, EINA_TRUE);
+        }
+    }
+
+    for (i = 0; i < (unsigned int)grid_y_nbr; i++)
+    {
+        for (j = 1; (int)j < (sub_grid_y_nbr - 1); j++)
+        {
+            double y;
+
+            y = h - y_area - h_area * (j + i * (sub_grid_y_nbr - 1)) / (double)((grid_y_nbr - 1) * (sub_grid_y_nbr - 1));
+            echart_grid_hline_add(grid, y, x_area + 1, x_area + w_area, color, EINA_TRUE);
+        }
+    }
+
+    echart_canvas_end(grid);
+
+    return EINA_TRUE;
+}
+
+/* the area and the line of the series j, from the current layout */
+static void
+_echart_line_series_draw(Echart_Line *line, const Echart_Data *data, unsigned int j,
+                         unsigned int *indices, unsigned int indices_size,
+                         Echart_Buffer *abuffer, Echart_Buffer *buffer, Echart_Buffer *pbuffer)
+{
+    const Echart_Data_Item *absciss;
+    const Echart_Data_Item *item;
+    const unsigned int *kept;
+    const double *values;
+    const double *points;
+    double ax_scale;
+    double ax_offset;
+    double y_scale;
+    double vmin;
+    double vmax;
+    unsigned int afirst;
+    unsigned int acount;
+    unsigned int count;
+    unsigned int n;
+    int x_area;
+    int y_area;
+    int w_area;
+    int h_area;
+    int h;
+
+    x_area = line->scene.x_area;
+    y_area = line->scene.y_area;
+    w_area = line->scene.w_area;
+    h_area = line->scene.h_area;
+    h = line->scene.h;
+    afirst = line->scene.afirst;
+    acount = line->scene.acount;
+
+    /*
+     * absciss to device coordinates, and the decimation of the series to
+     * the samples which are visible at the pixel level
+     */
+    if (line->scene.avmax > line->scene.avmin)
+    {
+        ax_scale = (w_area - 1) / (line->scene.avmax - line->scene.avmin);
+        ax_offset = x_area + 1 - line->scene.avmin * ax_scale;
+    }
+    else
+    {
+        /* a single absciss is drawn in the middle of the area */
+        ax_scale = 0.0;
+        ax_offset = x_area + 1 + (w_area - 1) / 2.0;
+    }
+
+    absciss = echart_data_absciss_get(data);
+    item = echart_data_items_get(data, j);
+    count = acount;
+    if (!_echart_line_series_get(line, data, j, afirst, &count, &values, &vmin, &vmax))
+    {
+        /* nothing is visible */
+        if (line->area)
+            echart_areas_set(line->scene.areas, j - 1, NULL, NULL, 0, h - y_area, x_area + 1, x_area + w_area);
+        echart_polylines_set(line->scene.lines, j - 1, NULL, NULL, 0);
+        return;
+    }
+
+    n = _echart_line_samples_get(line, absciss, item, values, afirst, count,
+                                 ax_offset, ax_scale, w_area,
+                                 indices, indices_size,
+                                 abuffer, buffer, &kept);
+
+    /* area, filled with the other ones at the end of the update */
+    if (line->area)
+    {
+        /* a flat series is on the base, its area being empty */
+        y_scale = (vmax > vmin) ? -(h_area - 1) / (vmax - vmin) : 0.0;
+        if (!isfinite(y_scale))
+            y_scale = 0.0;
+        points = _echart_line_points_get(absciss, item, values, afirst, kept, n,
+                                         ax_offset, ax_scale,
+                                         h - y_area - vmin * y_scale, y_scale,
+                                         pbuffer);
+        if (points &&
+            !echart_areas_set(line->scene.areas, j - 1, points, points + n, n, h - y_area,
+                              x_area + 1, x_area + w_area))
+            ERR("Could not set the area of the series %u", j);
+    }
+
+    /*
+     * line, drawn with the other ones at the end of the update, not drawn
+     * when its scale is not finite, vmax being 0
+     */
+    y_scale = -h_area / vmax;
+    if (!isfinite(y_scale))
+    {
+        echart_polylines_set(line->scene.lines, j - 1, NULL, NULL, 0);
+        return;
+    }
+
+    points = _echart_line_points_get(absciss, item, values, afirst, kept, n,
+                                     ax_offset, ax_scale,
+                                     h - y_area, y_scale,
+                                     pbuffer);
+    if (points && !echart_polylines_set(line->scene.lines, j - 1, points, points + n, n))
+        ERR("Could not set the line of the series %u", j);
+}
+
+static void
+_echart_line_series_style_set(Echart_Line *line, const Echart_Data_Item *item, unsigned int j)
+{
+    Enesim_Color color;
+    uint8_t ca, cr, cg, cb;
+
+    if (line->scene.areas)
+    {
+        enesim_argb_components_to(echart_data_item_color_get(item).area, &ca, &cr, &cg, &cb);
+        ca = 220;
+        enesim_color_components_from(&color, ca, cr, cg, cb);
+        echart_areas_color_set(line->scene.areas, j - 1, color);
+    }
+    enesim_argb_components_to(echart_data_item_color_get(item).line, &ca, &cr, &cg, &cb);
+    enesim_color_components_from(&color, ca, cr, cg, cb);
+    echart_polylines_color_set(line->scene.lines, j - 1, color);
+}
+
+static Eina_Bool
+_echart_line_series_resize(Echart_Line *line, unsigned int count)
+{
+    Echart_Line_Series *series;
+
+    if (count == line->scene.series_count)
+        return EINA_TRUE;
+
+    if (line->scene.areas && !echart_areas_count_set(line->scene.areas, count))
+        return EINA_FALSE;
+
+    if (!echart_polylines_count_set(line->scene.lines, count))
+        return EINA_FALSE;
+
+    if (count < line->scene.series_count)
+        line->scene.series_count = count;
+
+    series = (Echart_Line_Series *)realloc(line->scene.series, count * sizeof(Echart_Line_Series));
+    if (!series)
+        return EINA_FALSE;
+
+    /* generation 0: the new series are drawn from scratch */
+    if (count > line->scene.series_count)
+        memset(series + line->scene.series_count, 0,
+               (count - line->scene.series_count) * sizeof(Echart_Line_Series));
+    line->scene.series = series;
+    line->scene.series_count = count;
+
+    return EINA_TRUE;
+}
+
+/* the layers are only rebuilt when renderers are added or removed */
+static void
+_echart_line_layers_update(Echart_Line *line)
+{
+    Enesim_Renderer *c;
+
+    c = line->scene.compound;
+    enesim_renderer_compound_layer_clear(c);
+
+    _echart_line_layer_add(c, line->scene.background, ENESIM_ROP_FILL);
+    if (line->scene.title_shown)
+        _echart_line_layer_add(c, line->scene.title, ENESIM_ROP_BLEND);
+    _echart_line_layer_add(c, echart_labels_renderer_get(line->scene.labels), ENESIM_ROP_BLEND);
+    _echart_line_layer_add(c, line->scene.grid.renderer, ENESIM_ROP_BLEND);
+
+    if (line->area && line->scene.areas)
+        _echart_line_layer_add(c, echart_areas_renderer_get(line->scene.areas), ENESIM_ROP_BLEND);
+
+    _echart_line_layer_add(c, echart_polylines_renderer_get(line->scene.lines), ENESIM_ROP_BLEND);
+
+    line->scene.layers_dirty = 0;
+}
+
 /**
  * @endcond
  */
@@ -87,6 +736,9 @@ echart_line_new(void)
     if (!line)
         return NULL;
 
+    line->decimation = ECHART_DECIMATION_MINMAX;
+    line->stroke_weight = 1;
+
     return line;
 }
 
@@ -96,6 +748,7 @@ echart_line_chart_free(Echart_Line *line)
     if (!line)
         return;
 
+    _echart_line_scene_free(line);
     free(line);
 }
 
@@ -106,6 +759,7 @@ echart_line_chart_set(Echart_Line *line, const Echart_Chart *chart)
         return;
 
     line->chart = chart;
+    line->dirty = 1;
 }
 
 EAPI const Echart_Chart *
@@ -124,6 +778,8 @@ echart_line_area_set(Echart_Line *line, Eina_Bool area)
         return;
 
     line->area = !!area;
+    line->dirty = 1;
+    line->scene.layers_dirty = 1;
 }
 
 EAPI Eina_Bool
@@ -142,6 +798,7 @@ echart_line_stacked_set(Echart_Line *line, Eina_Bool stacked)
         return;
 
     line->stacked = !!stacked;
+    line->dirty = 1;
 }
 
 EAPI Eina_Bool
@@ -153,291 +810,290 @@ echart_line_stacked_get(const Echart_Line *line)
     return line->stacked;
 }
 
-EAPI Enesim_Renderer *
-echart_line_renderer_get(const Echart_Line *line)
+EAPI void
+echart_line_decimation_set(Echart_Line *line, Echart_Decimation decimation)
+{
+    if (!line || (line->decimation == decimation))
+        return;
+
+    line->decimation = decimation;
+    line->dirty = 1;
+}
+
+EAPI Echart_Decimation
+echart_line_decimation_get(const Echart_Line *line)
+{
+    if (!line)
+        return ECHART_DECIMATION_NONE;
+
+    return line->decimation;
+}
+
+EAPI void
+echart_line_stroke_weight_set(Echart_Line *line, double weight)
+{
+    if (!line || !(weight > 0) || !isfinite(weight) || (line->stroke_weight == weight))
+        return;
+
+    line->stroke_weight = weight;
+    line->dirty = 1;
+}
+
+EAPI double
+echart_line_stroke_weight_get(const Echart_Line *line)
+{
+    if (!line)
+        return 0;
+
+    return line->stroke_weight;
+}
+
+/*
+ * Brings the retained scene of the line up to date with its chart. Only
+ * what changed since the previous update is recomputed: the colors for a
+ * style change, the series whose visible values changed, and
+ * the labels, the grids and all the series when the visible part of the
+ * absciss or the size of the chart changed. The renderers are reused.
+ */
+EAPI Eina_Bool
+echart_line_update(Echart_Line *line)
 {
     const Echart_Chart *chart;
     const Echart_Data *data;
     const Echart_Data_Item *absciss;
     const Echart_Data_Item *item;
-    Enesim_Renderer *c;
-    Enesim_Renderer *r;
-    Enesim_Renderer *r_first;
-    Enesim_Renderer_Compound_Layer *l;
-    Enesim_Text_Font *f;
-    Enesim_Text_Engine *e;
-    Enesim_Rectangle geom;
-    Enesim_Path *p;
-    Enesim_Color color;
-    Eina_Rectangle rect_first;
-    Eina_Rectangle rect;
-    const char *title;
+    Echart_Buffer abuffer = { NULL, 0 };
+    Echart_Buffer pbuffer = { NULL, 0 };
+    Echart_Buffer buffer = { NULL, 0 };
+    Echart_Line_Series *s;
+    Eina_Rectangle clip;
+    Echart_Change chart_changes;
+    Echart_Change changes;
+    unsigned int *indices;
     double avmin;
     double avmax;
-    int grid_x_nbr;
-    int grid_y_nbr;
-    int sub_grid_x_nbr;
-    int sub_grid_y_nbr;
-    int x_area;
-    int y_area;
-    int w_area;
-    int h_area;
+    unsigned int afirst;
+    unsigned int acount;
+    unsigned int indices_size;
+    unsigned int first;
+    unsigned int nbr;
+    unsigned int j;
+    Eina_Bool full;
+    Eina_Bool frame;
+    Eina_Bool values;
+    Eina_Bool style;
     int w;
     int h;
-    unsigned int i;
-    unsigned int j;
 
     if (!line)
-        return NULL;
+        return EINA_FALSE;
 
     chart = line->chart;
 
-    if (line->stacked)
-      data = echart_data_stacked_get(echart_chart_data_get(chart));
-    else
-      data = echart_chart_data_get(chart);
+    data = echart_chart_data_get(chart);
     if (!data)
     {
         ERR("A chart must have at least a data");
-        return NULL;
+        return EINA_FALSE;
     }
 
     if (echart_data_items_count(data) < 2)
     {
         ERR("Data must have at least 2 items");
-        return NULL;
+        return EINA_FALSE;
     }
 
-    echart_chart_size_get(chart, &w, &h);
-
-    c = enesim_renderer_compound_new();
-
-    e = enesim_text_engine_default_get();
-    f = enesim_text_font_new_description_from(e, "arial", 16);
-    enesim_text_engine_unref(e);
-
-    /* background */
-    r = enesim_renderer_rectangle_new();
-    enesim_renderer_rectangle_position_set(r, 0, 0);
-    enesim_renderer_rectangle_size_set(r, w, h);
-    enesim_renderer_shape_fill_color_set(r, echart_chart_background_color_get(chart));
-    enesim_renderer_shape_draw_mode_set(r, ENESIM_RENDERER_SHAPE_DRAW_MODE_FILL);
-
-    l = enesim_renderer_compound_layer_new();
-    enesim_renderer_compound_layer_renderer_set(l, r);
-    enesim_renderer_compound_layer_rop_set(l, ENESIM_ROP_FILL);
-    enesim_renderer_compound_layer_add(c, l);
-
-    /* title */
-    h_area = 0;
-    title = echart_data_title_get(data);
-    if (title)
+    if (!line->scene.compound && !_echart_line_scene_new(line))
     {
-        r = enesim_renderer_text_span_new();
-        enesim_renderer_color_set(r, 0xff000000);
-        enesim_renderer_text_span_text_set(r, title);
-        enesim_renderer_text_span_font_set(r, f);
-
-        enesim_renderer_shape_destination_geometry_get(r, &geom);
-        enesim_renderer_origin_set(r, (w - geom.w) / 2, 0);
-        enesim_rectangle_normalize(&geom, &rect);
-        h_area = rect.h;
-
-        ECHART_RENDERER_LAYER_ADD(c, l, r);
+        ERR("Could not create the scene of the line");
+        return EINA_FALSE;
     }
 
-    /* abscisses */
-
+    full = line->dirty || (line->scene.data != data);
+    chart_changes = echart_chart_changes_get(chart, full ? 0 : line->scene.chart_generation);
     absciss = echart_data_absciss_get(data);
-    echart_data_item_interval_get(absciss, &avmin, &avmax);
-
-    r_first = _echart_line_text_renderer_from_double(f, *(double *)eina_list_nth(echart_data_item_values_get(absciss), 0));
-
-    enesim_renderer_shape_destination_geometry_get(r_first, &geom);
-    enesim_renderer_origin_set(r_first, 0, h - geom.h);
-    enesim_rectangle_normalize(&geom, &rect_first);
-    x_area = rect_first.w / 2 + 1;
-    y_area = rect_first.h;
-
-    ECHART_RENDERER_LAYER_ADD(c, l, r_first);
-
-    r = _echart_line_text_renderer_from_double(f, *(double *)eina_list_nth(echart_data_item_values_get(absciss), eina_list_count(echart_data_item_values_get(absciss)) - 1));
-
-    enesim_renderer_shape_destination_geometry_get(r, &geom);
-    enesim_renderer_origin_set(r, w - geom.w, h - geom.h);
-    enesim_rectangle_normalize(&geom, &rect);
-    w_area = w - (rect_first.w + rect.w) / 2;
-    if (y_area < rect.h)
-        y_area = rect.h;
-
-    ECHART_RENDERER_LAYER_ADD(c, l, r);
-
-    for (i = 1; i < eina_list_count(echart_data_item_values_get(absciss)) - 1; i++)
+    changes = echart_data_item_changes_get(absciss, full ? 0 : line->scene.absciss_generation,
+                                           line->scene.absciss_count, NULL, NULL);
+
+    /*
+     * the visible part of the absciss, located by binary search when a
+     * viewport is set, the absciss being sorted
+     */
+    afirst = 0;
+    acount = echart_data_item_values_count(absciss);
+    if (echart_chart_viewport_get(chart, &avmin, &avmax))
     {
-        double d1;
-
-        r = _echart_line_text_renderer_from_double(f, *(double *)eina_list_nth(echart_data_item_values_get(absciss), i));
-
-        d1 = *(double *)eina_list_nth(echart_data_item_values_get(absciss), i);
-        d1 = x_area + w_area * (d1 - avmin) / (avmax - avmin);
-
-        enesim_renderer_shape_destination_geometry_get(r, &geom);
-        enesim_renderer_origin_set(r, d1 - geom.w / 2, h - geom.h);
-        enesim_rectangle_normalize(&geom, &rect);
-        if (y_area < rect.h)
-            y_area = rect.h;
-
-        ECHART_RENDERER_LAYER_ADD(c, l, r);
+        echart_data_item_range_find(absciss, avmin, avmax, &afirst, &acount);
+        /*
+         * with one more sample on each side, the lines reach the borders of
+         * the area, where they are clipped
+         */
+        if (afirst)
+        {
+            afirst--;
+            acount++;
+        }
+        if (afirst + acount < echart_data_item_values_count(absciss))
+            acount++;
     }
-    h_area = h - y_area - h_area;
+    else
+        echart_data_item_interval_get(absciss, &avmin, &avmax);
 
-    /* grid */
-    echart_chart_grid_nbr_get(chart, &grid_x_nbr, &grid_y_nbr);
-    for (i = 0; i < (unsigned int)grid_x_nbr; i++)
-    {
-        r = enesim_renderer_line_new();
-        enesim_renderer_line_coords_set(r,
-                                        x_area + (i * w_area) / (double)(grid_x_nbr - 1), h - y_area,
-                                        x_area + (i * w_area) / (double)(grid_x_nbr - 1), h - h_area - y_area);
-        enesim_renderer_shape_stroke_weight_set(r, 1);
-        if (i == 0)
-            enesim_renderer_shape_stroke_color_set(r, 0xff000000);
-        else
-            enesim_renderer_shape_stroke_color_set(r, echart_chart_grid_color_get(chart));
-        enesim_renderer_shape_draw_mode_set(r, ENESIM_RENDERER_SHAPE_DRAW_MODE_STROKE);
+    echart_chart_size_get(chart, &w, &h);
 
-        ECHART_RENDERER_LAYER_ADD(c, l, r);
-    }
+    /* values appended out of the visible part leave the frame as is */
+    frame = full ||
+        (chart_changes & (ECHART_CHANGE_SIZE | ECHART_CHANGE_VIEWPORT | ECHART_CHANGE_DATA)) ||
+        echart_data_changes_get(data, line->scene.data_generation) ||
+        (changes & (ECHART_CHANGE_RESET | ECHART_CHANGE_SHIFT)) ||
+        ((changes & ECHART_CHANGE_VALUES) &&
+         ((afirst != line->scene.afirst) || (acount != line->scene.acount) ||
+          (avmin != line->scene.avmin) || (avmax != line->scene.avmax)));
 
-    for (i = 0; i < (unsigned int)grid_y_nbr; i++)
+    if (chart_changes & (ECHART_CHANGE_SIZE | ECHART_CHANGE_STYLE))
     {
-        r = enesim_renderer_line_new();
-        enesim_renderer_line_coords_set(r,
-                                        x_area + 1, h - y_area - (i * h_area) / (double)(grid_y_nbr - 1),
-                                        x_area + w_area, h - y_area - (i * h_area) / (double)(grid_y_nbr - 1));
-        enesim_renderer_shape_stroke_weight_set(r, 1);
-        if (i == 0)
-            enesim_renderer_shape_stroke_color_set(r, 0xff000000);
-        else
-            enesim_renderer_shape_stroke_color_set(r, echart_chart_grid_color_get(chart));
-        enesim_renderer_shape_draw_mode_set(r, ENESIM_RENDERER_SHAPE_DRAW_MODE_STROKE);
-
-        ECHART_RENDERER_LAYER_ADD(c, l, r);
+        enesim_renderer_rectangle_size_set(line->scene.background, w, h);
+        enesim_renderer_shape_fill_color_set(line->scene.background, echart_chart_background_color_get(chart));
     }
 
-    /* sub grid */
-    echart_chart_sub_grid_nbr_get(chart, &sub_grid_x_nbr, &sub_grid_y_nbr);
-    for (i = 0; i < (unsigned int)grid_x_nbr; i++)
+    if (frame)
     {
-        for (j = 1; (int)j < (sub_grid_x_nbr - 1); j++)
-        {
-            p = enesim_path_new();
-            enesim_path_move_to(p, x_area + w_area * (j + i * (sub_grid_x_nbr - 1)) / (double)((grid_x_nbr - 1) * (sub_grid_x_nbr - 1)), h - h_area - y_area + 1);
-            enesim_path_line_to(p, x_area + w_area * (j + i * (sub_grid_x_nbr - 1)) / (double)((grid_x_nbr - 1) * (sub_grid_x_nbr - 1)), h - y_area);
-
-            r = enesim_renderer_path_new();
-            enesim_renderer_path_path_set(r, p);
-            enesim_renderer_shape_stroke_weight_set(r, 1);
-            enesim_renderer_shape_stroke_dash_add_simple(r, 10, 8);
-            enesim_renderer_shape_stroke_color_set(r, echart_chart_sub_grid_color_get(chart));
-            enesim_renderer_shape_draw_mode_set(r, ENESIM_RENDERER_SHAPE_DRAW_MODE_STROKE);
-
-            ECHART_RENDERER_LAYER_ADD(c, l, r);
-        }
+        line->scene.w = w;
+        line->scene.h = h;
+        line->scene.avmin = avmin;
+        line->scene.avmax = avmax;
+        line->scene.afirst = afirst;
+        line->scene.acount = acount;
+        if (!_echart_line_frame_update(line, data))
+            goto on_error;
     }
 
-    for (i = 0; i < (unsigned int)grid_y_nbr; i++)
+    if ((frame || (chart_changes & ECHART_CHANGE_STYLE)) &&
+        !_echart_line_grid_update(line, chart))
+        goto on_error;
+
+    /* the colors of the areas are set when they are created */
+    style = EINA_FALSE;
+    if (line->area && !line->scene.areas)
     {
-        for (j = 1; (int)j < (sub_grid_y_nbr - 1); j++)
-        {
-            p = enesim_path_new();
-            enesim_path_move_to(p, x_area + 1, h - y_area - h_area * (j + i * (sub_grid_y_nbr - 1)) / (double)((grid_y_nbr - 1) * (sub_grid_y_nbr - 1)));
-            enesim_path_line_to(p, x_area + w_area, h - y_area - h_area * (j + i * (sub_grid_y_nbr - 1)) / (double)((grid_y_nbr - 1) * (sub_grid_y_nbr - 1)));
-
-            r = enesim_renderer_path_new();
-            enesim_renderer_path_path_set(r, p);
-            enesim_renderer_shape_stroke_weight_set(r, 1);
-            enesim_renderer_shape_stroke_dash_add_simple(r, 10, 8);
-            enesim_renderer_shape_stroke_color_set(r, echart_chart_sub_grid_color_get(chart));
-            enesim_renderer_shape_draw_mode_set(r, ENESIM_RENDERER_SHAPE_DRAW_MODE_STROKE);
-
-            ECHART_RENDERER_LAYER_ADD(c, l, r);
-        }
+        line->scene.areas = echart_areas_new();
+        if (!line->scene.areas ||
+            !echart_areas_count_set(line->scene.areas, line->scene.series_count))
+            goto on_error;
+        line->scene.layers_dirty = 1;
+        style = EINA_TRUE;
     }
 
-    /* area */
-    if (line->area)
+    /* series */
+    if (!_echart_line_series_resize(line, echart_data_items_count(data) - 1))
+        goto on_error;
+
+    /* in stacked mode, the values of a series move the ones above it */
+    values = EINA_FALSE;
+    if (line->stacked && !frame)
     {
         for (j = 1; j < echart_data_items_count(data); j++)
         {
-            double vmin;
-            double vmax;
-            double d1;
-            double d2;
-            uint8_t ca, cr, cg, cb;
-
-            item = echart_data_items_get(data, j);
-            echart_data_item_interval_get(item, &vmin, &vmax);
-
-            p = enesim_path_new();
-            enesim_path_move_to(p, x_area + 1, h - y_area);
-            for (i = 0; i < eina_list_count(echart_data_item_values_get(item)); i++)
-            {
-                d1 = *(double *)eina_list_nth(echart_data_item_values_get(absciss), i);
-                d1 = x_area + 1 + (w_area - 1) * (d1 - avmin) / (avmax - avmin);
-                d2 = *(double *)eina_list_nth(echart_data_item_values_get(item), i);
-                d2 = (h_area - 1) * (d2 - vmin) / (vmax - vmin);
-                enesim_path_line_to(p, d1, h - y_area - d2);
-            }
-            enesim_path_line_to(p, x_area + w_area, h - y_area);
-            enesim_path_close(p);
-
-            r = enesim_renderer_path_new();
-            enesim_renderer_path_path_set(r, p);
-            enesim_argb_components_to(echart_data_item_color_get(item).area, &ca, &cr, &cg, &cb);
-            ca = 220;
-            enesim_color_components_from(&color, ca, cr, cg, cb);
-            enesim_renderer_shape_fill_color_set(r, color);
-            enesim_renderer_shape_draw_mode_set(r, ENESIM_RENDERER_SHAPE_DRAW_MODE_FILL);
-
-            ECHART_RENDERER_LAYER_ADD(c, l, r);
+            s = line->scene.series + j - 1;
+            changes = echart_data_item_changes_get(echart_data_items_get(data, j),
+                                                   s->generation, s->count, NULL, NULL);
+            if (changes & (ECHART_CHANGE_VALUES | ECHART_CHANGE_RESET | ECHART_CHANGE_SHIFT))
+                values = EINA_TRUE;
         }
     }
 
-    /* line */
+    /* the stacked view is brought up to date once for all the series */
+    if (line->stacked && (frame || values) && !echart_data_stacked_update(data))
+        ERR("Could not compute the stacked values");
+
+    indices = NULL;
+    indices_size = echart_decimate_size(line->decimation, acount, line->scene.w_area);
+    if (indices_size && (indices_size < echart_lod_size(line->scene.w_area)))
+        indices_size = echart_lod_size(line->scene.w_area);
+
     for (j = 1; j < echart_data_items_count(data); j++)
     {
-        double vmin;
-        double vmax;
-        double d1;
-        double d2;
-
         item = echart_data_items_get(data, j);
-        echart_data_item_interval_get(item, &vmin, &vmax);
-        printf("\n%d  %f  %f\n\n", j, vmin, vmax);
+        s = line->scene.series + j - 1;
+        changes = echart_data_item_changes_get(item, s->generation, s->count, &first, &nbr);
 
-        p = enesim_path_new();
-        for (i = 0; i < eina_list_count(echart_data_item_values_get(item)); i++)
+        if (frame || values || (changes & (ECHART_CHANGE_RESET | ECHART_CHANGE_SHIFT)) ||
+            ((changes & ECHART_CHANGE_VALUES) &&
+             (first < afirst + acount) && (first + nbr > afirst)))
         {
-            d1 = *(double *)eina_list_nth(echart_data_item_values_get(absciss), i);
-            d1 = x_area + 1 + (w_area - 1) * (d1 - avmin) / (avmax - avmin);
-            d2 = *(double *)eina_list_nth(echart_data_item_values_get(item), i);
-            d2 = h_area * (d2) / (vmax);
-            if (i == 0)
-                enesim_path_move_to(p, d1, h - y_area - d2);
-            else
-                enesim_path_line_to(p, d1, h - y_area - d2);
-            printf("%d %d %f\n", j, i, h - y_area - d2);
+            /* the scratch memory is only allocated when a series is drawn */
+            if (indices_size && !indices)
+            {
+                indices = (unsigned int *)malloc(indices_size * sizeof(unsigned int));
+                if (!indices)
+                    indices_size = 0;
+            }
+
+            if (!s->drawn)
+            {
+                changes |= ECHART_CHANGE_STYLE;
+                s->drawn = 1;
+            }
+            _echart_line_series_draw(line, data, j, indices, indices_size,
+                                     &abuffer, &buffer, &pbuffer);
         }
 
-        r = enesim_renderer_path_new();
-        enesim_renderer_path_path_set(r, p);
-        enesim_renderer_shape_stroke_weight_set(r, 1);
-        enesim_renderer_shape_stroke_color_set(r, echart_data_item_color_get(item).line);
-        enesim_renderer_shape_draw_mode_set(r, ENESIM_RENDERER_SHAPE_DRAW_MODE_STROKE);
+        if (style || (changes & ECHART_CHANGE_STYLE))
+            _echart_line_series_style_set(line, item, j);
 
-        ECHART_RENDERER_LAYER_ADD(c, l, r);
+        s->generation = echart_data_item_generation_get(item);
+        s->count = echart_data_item_values_count(item);
     }
 
-    return c;
+    free(indices);
+    echart_buffer_free(&pbuffer);
+    echart_buffer_free(&abuffer);
+    echart_buffer_free(&buffer);
+
+    /* all the areas in one pass, if one of them changed */
+    if (line->area && !echart_areas_update(line->scene.areas))
+        goto on_error;
+
+    /* all the lines in one canvas, clipped to the box of the grid */
+    eina_rectangle_coords_from(&clip,
+                               line->scene.x_area - 1, line->scene.h - line->scene.h_area - line->scene.y_area - 1,
+                               line->scene.w_area + 2, line->scene.h_area + 2);
+    if (!echart_polylines_update(line->scene.lines, line->stroke_weight, &clip))
+        goto on_error;
+
+    if (line->scene.layers_dirty)
+        _echart_line_layers_update(line);
+
+    line->scene.data = data;
+    line->scene.chart_generation = echart_chart_generation_get(chart);
+    line->scene.data_generation = echart_data_generation_get(data);
+    line->scene.absciss_generation = echart_data_item_generation_get(absciss);
+    line->scene.absciss_count = echart_data_item_values_count(absciss);
+    line->dirty = 0;
+
+    return EINA_TRUE;
+
+  on_error:
+    ERR("Could not update the scene of the line");
+    /* the next update starts from scratch */
+    line->dirty = 1;
+    return EINA_FALSE;
+}
+
+/*
+ * The retained scene of the line, brought up to date. A new reference is
+ * returned, the line keeping the scene for the next updates. The same
+ * compound is returned by each call and patched in place by the next
+ * update of the line, so it must not be drawn while the line is updated.
+ */
+EAPI Enesim_Renderer *
+echart_line_renderer_get(Echart_Line *line)
+{
+    if (!line)
+        return NULL;
+
+    if (!echart_line_update(line))
+        return NULL;
+
+    return enesim_renderer_ref(line->scene.compound);
 }
@@ -0,0 +1,483 @@
+/* Echart - Chart rendering library
+ * Copyright (C) 2013 Vincent Torri
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <Enesim.h>
+
+#include "Echart.h"
+#include "echart_private.h"
+
+/*============================================================================*
+ *                                  Local                                     *
+ *============================================================================*/
+
+/**
+ * @cond LOCAL
+ */
+
+/*
+ * The pyramid is made of levels of buckets: a bucket of level k covers
+ * 2^(ECHART_LOD_SHIFT + k) consecutive samples and holds their minimum and
+ * maximum, with the indices of the samples they come from. Level k + 1 is
+ * built by merging pairs of buckets of level k.
+ */
+#define ECHART_LOD_LEVELS_MAX 32
+
+typedef struct _Echart_Lod_Node Echart_Lod_Node;
+typedef struct _Echart_Lod_Level Echart_Lod_Level;
+
+struct _Echart_Lod_Node
+{
+    double vmin;
+    double vmax;
+    unsigned int imin;
+    unsigned int imax;
+};
+
+/*
+ * The nodes are stored in a buffer of the shared mode, so that a level is
+ * never moved while a reader of a shared data reads it.
+ */
+struct _Echart_Lod_Level
+{
+    Echart_Shared_Buffer *buffer;
+    Echart_Lod_Node *nodes;
+    unsigned int count;
+    unsigned int alloc;
+};
+
+/*
+ * In shared mode, the single writer appends samples while the readers read
+ * views of the pyramid. A bucket is never written again once all its
+ * samples are appended, and the readers only read the complete buckets of
+ * the samples published with their release semantic.
+ */
+struct _Echart_Lod
+{
+    Echart_Lod_Level levels[ECHART_LOD_LEVELS_MAX];
+    unsigned int levels_count;
+    unsigned int count;
+    /* shared mode: epochs of the readers and count of the published samples */
+    Echart_Shared *shared;
+    unsigned int published;
+    /* view of a reader, the levels belong to the pyramid it is made from */
+    Eina_Bool view;
+};
+
+static Eina_Bool
+_echart_lod_level_grow(Echart_Lod *lod, Echart_Lod_Level *level, unsigned int count)
+{
+    Echart_Shared_Buffer *buffer;
+    Echart_Lod_Node *nodes;
+    unsigned int alloc;
+
+    if (count <= level->alloc)
+        return EINA_TRUE;
+
+    alloc = level->alloc ? level->alloc : 16;
+    while (alloc < count)
+        alloc *= 2;
+
+    buffer = echart_shared_buffer_new(alloc * sizeof(Echart_Lod_Node));
+    if (!buffer)
+        return EINA_FALSE;
+
+    nodes = (Echart_Lod_Node *)echart_shared_buffer_values_get(buffer);
+    if (level->count)
+        memcpy(nodes, level->nodes, level->count * sizeof(Echart_Lod_Node));
+
+    /* the readers may still read the current nodes */
+    if (lod->shared)
+        echart_shared_buffer_replace(lod->shared, &level->buffer, buffer);
+    else
+    {
+        echart_shared_buffer_free(level->buffer);
+        level->buffer = buffer;
+    }
+
+    level->nodes = nodes;
+    level->alloc = alloc;
+
+    return EINA_TRUE;
+}
+
+static inline void
+_echart_lod_node_merge(Echart_Lod_Node *node, const Echart_Lod_Node *n1, const Echart_Lod_Node *n2)
+{
+    *node = *n1;
+    if (!n2)
+        return;
+
+    if (n2->vmin < node->vmin)
+    {
+        node->vmin = n2->vmin;
+        node->imin = n2->imin;
+    }
+    if (n2->vmax > node->vmax)
+    {
+        node->vmax = n2->vmax;
+        node->imax = n2->imax;
+    }
+}
+
+static inline unsigned int
+_echart_lod_emit(unsigned int *indices, unsigned int n, unsigned int idx)
+{
+    if (!n || (indices[n - 1] < idx))
+        indices[n++] = idx;
+
+    return n;
+}
+
+/**
+ * @endcond
+ */
+
+/*============================================================================*
+ *                                 Global                                     *
+ *============================================================================*/
+
+Echart_Lod *
+echart_lod_new(void)
+{
+    return (Echart_Lod *)calloc(1, sizeof(Echart_Lod));
+}
+
+void
+echart_lod_free(Echart_Lod *lod)
+{
+    if (!lod)
+        return;
+
+    echart_lod_clear(lod);
+    free(lod);
+}
+
+void
+echart_lod_clear(Echart_Lod *lod)
+{
+    Echart_Shared *shared;
+    unsigned int i;
+
+    /* the levels grown by a failed append are above levels_count */
+    if (!lod->view)
+    {
+        for (i = 0; i < ECHART_LOD_LEVELS_MAX; i++)
+        {
+            if (!lod->levels[i].buffer)
+                break;
+            if (lod->shared)
+                echart_shared_buffer_replace(lod->shared, &lod->levels[i].buffer, NULL);
+            else
+                echart_shared_buffer_free(lod->levels[i].buffer);
+        }
+    }
+
+    shared = lod->shared;
+    memset(lod->levels, 0, sizeof(lod->levels));
+    lod->levels_count = 0;
+    lod->count = 0;
+    if (shared)
+        __atomic_store_n(&lod->published, 0, __ATOMIC_RELEASE);
+}
+
+unsigned int
+echart_lod_count(const Echart_Lod *lod)
+{
+    return lod->count;
+}
+
+/*
+ * Called by the writer. In shared mode, the samples appended to the pyramid
+ * are published to the views created next, the levels are retired instead
+ * of freed when they are moved. Outside of it, no view must be left.
+ */
+void
+echart_lod_shared_set(Echart_Lod *lod, Echart_Shared *shared)
+{
+    lod->shared = shared;
+    __atomic_store_n(&lod->published, shared ? lod->count : 0, __ATOMIC_RELEASE);
+}
+
+/*
+ * Called by a reader of a shared pyramid, in an epoch of its shared mode
+ * which must last as long as the view. The view covers the first count
+ * samples, or less if they are not published yet in the pyramid, and can
+ * only be fetched or queried.
+ */
+Echart_Lod *
+echart_lod_view_new(const Echart_Lod *lod, unsigned int count)
+{
+    Echart_Lod *view;
+    unsigned int published;
+    unsigned int k;
+
+    view = (Echart_Lod *)calloc(1, sizeof(Echart_Lod));
+    if (!view)
+        return NULL;
+
+    view->view = EINA_TRUE;
+    published = __atomic_load_n(&lod->published, __ATOMIC_ACQUIRE);
+    if (count > published)
+        count = published;
+
+    /* only the complete buckets are read by the view */
+    for (k = 0; k < ECHART_LOD_LEVELS_MAX; k++)
+    {
+        const Echart_Shared_Buffer *buffer;
+        unsigned int n;
+
+        n = count >> (ECHART_LOD_SHIFT + k);
+        if (k && !n)
+            break;
+
+        buffer = echart_shared_buffer_get(&lod->levels[k].buffer);
+        if (!buffer)
+            break;
+
+        view->levels[k].nodes = (Echart_Lod_Node *)echart_shared_buffer_values_get(buffer);
+        view->levels[k].count = n;
+    }
+    view->levels_count = k;
+    view->count = count;
+
+    return view;
+}
+
+Eina_Bool
+echart_lod_view_get(const Echart_Lod *lod)
+{
+    return lod->view;
+}
+
+Eina_Bool
+echart_lod_append(Echart_Lod *lod, const double *values, unsigned int count)
+{
+    Echart_Lod_Level *level;
+    unsigned int first;
+    unsigned int start;
+    unsigned int i;
+    unsigned int k;
+    unsigned int n;
+
+    if (!count)
+        return EINA_TRUE;
+
+    if (lod->view)
+        return EINA_FALSE;
+
+    start = lod->count;
+
+    /* the levels are grown first, so that the pyramid is unchanged on failure */
+    n = ((start + count - 1) >> ECHART_LOD_SHIFT) + 1;
+    for (k = 0; k < ECHART_LOD_LEVELS_MAX; k++)
+    {
+        if (!_echart_lod_level_grow(lod, lod->levels + k, n))
+            return EINA_FALSE;
+        if (n <= 1)
+            break;
+        n = (n + 1) / 2;
+    }
+
+    /* level 0 is built from the samples */
+    if (!lod->levels_count)
+        lod->levels_count = 1;
+    level = lod->levels;
+
+    for (i = 0; i < count; i++)
+    {
+        Echart_Lod_Node *node;
+        unsigned int b;
+        double v;
+
+        v = values[i];
+        b = (start + i) >> ECHART_LOD_SHIFT;
+        node = level->nodes + b;
+        if (b == level->count)
+        {
+            node->vmin = v;
+            node->vmax = v;
+            node->imin = start + i;
+            node->imax = start + i;
+            level->count++;
+        }
+        else
+        {
+            if (v < node->vmin)
+            {
+                node->vmin = v;
+                node->imin = start + i;
+            }
+            if (v > node->vmax)
+            {
+                node->vmax = v;
+                node->imax = start + i;
+            }
+        }
+    }
+    lod->count += count;
+
+    /* the upper levels are rebuilt from the first modified bucket */
+    first = start >> ECHART_LOD_SHIFT;
+    for (k = 1; k < ECHART_LOD_LEVELS_MAX; k++)
+    {
+        Echart_Lod_Level *lower;
+        unsigned int b;
+
+        lower = lod->levels + k - 1;
+        if (lower->count <= 1)
+            break;
+
+        level = lod->levels + k;
+        if (k >= lod->levels_count)
+            lod->levels_count = k + 1;
+
+        first >>= 1;
+        for (b = first; b < (lower->count + 1) / 2; b++)
+        {
+            _echart_lod_node_merge(level->nodes + b,
+                                   lower->nodes + 2 * b,
+                                   (2 * b + 1 < lower->count) ? lower->nodes + 2 * b + 1 : NULL);
+        }
+        level->count = (lower->count + 1) / 2;
+    }
+
+    if (lod->shared)
+        __atomic_store_n(&lod->published, lod->count, __ATOMIC_RELEASE);
+
+    return EINA_TRUE;
+}
+
+/*
+ * start and end must be multiples of the size of the buckets of level 0. The
+ * range is covered by the largest aligned buckets, so at most 2 buckets per
+ * level are read.
+ */
+Eina_Bool
+echart_lod_interval_get(const Echart_Lod *lod, unsigned int start, unsigned int end, double *vmin, double *vmax)
+{
+    unsigned int pos;
+    Eina_Bool first;
+
+    if ((end > lod->count) || (start >= end) ||
+        ((start | end) & ((1U << ECHART_LOD_SHIFT) - 1)))
+        return EINA_FALSE;
+
+    first = EINA_TRUE;
+    pos = start;
+    while (pos < end)
+    {
+        const Echart_Lod_Node *node;
+        unsigned int bsize;
+        int k;
+
+        for (k = lod->levels_count - 1; k > 0; k--)
+        {
+            bsize = 1U << (ECHART_LOD_SHIFT + k);
+            if (!(pos & (bsize - 1)) && (pos + bsize <= end))
+                break;
+        }
+
+        bsize = 1U << (ECHART_LOD_SHIFT + k);
+        node = lod->levels[k].nodes + (pos >> (ECHART_LOD_SHIFT + k));
+        if (first || (node->vmin < *vmin)) *vmin = node->vmin;
+        if (first || (node->vmax > *vmax)) *vmax = node->vmax;
+        first = EINA_FALSE;
+        pos += bsize;
+    }
+
+    return EINA_TRUE;
+}
+
+unsigned int
+echart_lod_size(unsigned int width)
+{
+    /*
+     * 2 samples per bucket and at most 2 buckets per pixel, plus one
+     * bucket per level on both sides of the range, plus the samples of
+     * the partial buckets of level 0 and the range bounds
+     */
+    return 4 * (width + 1) + 4 * ECHART_LOD_LEVELS_MAX + 2 * (1 << ECHART_LOD_SHIFT) + 2;
+}
+
+unsigned int
+echart_lod_fetch(const Echart_Lod *lod, unsigned int start, unsigned int end, unsigned int width,
+                 unsigned int *indices, unsigned int size)
+{
+    unsigned int top;
+    unsigned int pos;
+    unsigned int n;
+    int k;
+
+    if ((end > lod->count) || (start >= end) || !width || (size < echart_lod_size(width)))
+        return 0;
+
+    /* the coarsest level whose buckets are not larger than a pixel */
+    top = 0;
+    while ((top + 1 < lod->levels_count) &&
+           ((1U << (ECHART_LOD_SHIFT + top + 1)) <= (end - start) / width))
+        top++;
+
+    if ((1U << (ECHART_LOD_SHIFT + top)) > (end - start) / width)
+        return 0;
+
+    n = _echart_lod_emit(indices, 0, start);
+    pos = start;
+    while (pos < end)
+    {
+        for (k = top; k >= 0; k--)
+        {
+            const Echart_Lod_Node *node;
+            unsigned int bsize;
+
+            bsize = 1U << (ECHART_LOD_SHIFT + k);
+            if ((pos & (bsize - 1)) || (pos + bsize > end))
+                continue;
+
+            node = lod->levels[k].nodes + (pos >> (ECHART_LOD_SHIFT + k));
+            if (node->imin < node->imax)
+            {
+                n = _echart_lod_emit(indices, n, node->imin);
+                n = _echart_lod_emit(indices, n, node->imax);
+            }
+            else
+            {
+                n = _echart_lod_emit(indices, n, node->imax);
+                n = _echart_lod_emit(indices, n, node->imin);
+            }
+            pos += bsize;
+            break;
+        }
+
+        /* not aligned on a bucket of level 0 */
+        if (k < 0)
+        {
+            n = _echart_lod_emit(indices, n, pos);
+            pos++;
+        }
+
+        if (n + 2 > size)
+            return 0;
+    }
+    n = _echart_lod_emit(indices, n, end - 1);
+
+    return n;
+}
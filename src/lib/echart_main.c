@@ -45,6 +45,50 @@ static int _echart_init_count = 0;
 
 int echart_log_dom_global = -1;
 
+/* every kind of change is stamped with the initial generation */
+void
+echart_generation_init(Echart_Generation *generation)
+{
+    unsigned int i;
+
+    generation->current = 1;
+    for (i = 0; i < ECHART_CHANGE_KINDS; i++)
+        generation->changes[i] = 1;
+}
+
+void
+echart_generation_bump(Echart_Generation *generation, Echart_Change change)
+{
+    unsigned int i;
+
+    generation->current++;
+    /* 0 is kept for the consumers which have seen nothing */
+    if (!generation->current)
+        generation->current++;
+
+    for (i = 0; i < ECHART_CHANGE_KINDS; i++)
+    {
+        if (change & (1 << i))
+            generation->changes[i] = generation->current;
+    }
+}
+
+Echart_Change
+echart_generation_changes_get(const Echart_Generation *generation, unsigned int since)
+{
+    Echart_Change change;
+    unsigned int i;
+
+    change = ECHART_CHANGE_NONE;
+    for (i = 0; i < ECHART_CHANGE_KINDS; i++)
+    {
+        if (!since || ECHART_GENERATION_AFTER(generation->changes[i], since))
+            change |= (1 << i);
+    }
+
+    return change;
+}
+
 /*============================================================================*
  *                                   API                                      *
  *============================================================================*/
@@ -75,8 +119,18 @@ echart_init(void)
         goto unregister_log_domain;
     }
 
+    if (!echart_font_init())
+    {
+        ERR("Could not initialize the font cache.");
+        goto shutdown_enesim;
+    }
+
+    echart_simd_init();
+
     return _echart_init_count;
 
+  shutdown_enesim:
+    enesim_shutdown();
   unregister_log_domain:
     eina_log_domain_unregister(echart_log_dom_global);
     echart_log_dom_global = -1;
@@ -97,6 +151,7 @@ echart_shutdown(void)
     if (--_echart_init_count != 0)
         return _echart_init_count;
 
+    echart_font_shutdown();
     enesim_shutdown();
     eina_log_domain_unregister(echart_log_dom_global);
     echart_log_dom_global = -1;
@@ -0,0 +1,528 @@
+/* Echart - Chart rendering library
+ * Copyright (C) 2013 Vincent Torri
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include <Enesim.h>
+
+#include "Echart.h"
+#include "echart_private.h"
+
+/*============================================================================*
+ *                                  Local                                     *
+ *============================================================================*/
+
+/**
+ * @cond LOCAL
+ */
+
+/*
+ * The series are polylines whose x is (almost always) increasing, so in
+ * each column of pixels they cover a single band. The band of a column is
+ * the interval of y of the pieces of segments in the column, widened by
+ * the half weight of the stroke, in the direction of the segments for
+ * the flat ones. Thicker strokes widen the bands over the columns around.
+ * The coverage of a pixel is then the part of it inside the band of its
+ * column.
+ */
+
+/* the half weight of the widest stroke, the wider ones are drawn with it */
+#define ECHART_POLYLINE_RADIUS_MAX 1024
+
+typedef struct _Echart_Polyline Echart_Polyline;
+
+/* the polyline through the points (x[k], y[k]), and their bounds */
+struct _Echart_Polyline
+{
+    double *x;
+    double *y;
+    unsigned int count;
+    unsigned int alloc;
+    double xmin;
+    double xmax;
+    double ymin;
+    double ymax;
+    Enesim_Color color;
+};
+
+/*
+ * All the polylines of a chart, drawn in a single canvas covering them,
+ * in their order. The canvas and its layer are shared by the polylines,
+ * so their count changes neither the memory of the scene nor the number
+ * of layers blended when it is drawn.
+ */
+struct _Echart_Polylines
+{
+    Echart_Polyline *polylines;
+    unsigned int count;
+    /* the stroke and the clip rectangle of the last update */
+    double weight;
+    Eina_Rectangle clip;
+    unsigned int dirty : 1;
+    Echart_Canvas canvas;
+};
+
+/* the length of [a0, a1] inside [b0, b1] */
+static inline double
+_echart_polyline_overlap(double a0, double a1, double b0, double b1)
+{
+    if (a0 < b0)
+        a0 = b0;
+    if (a1 > b1)
+        a1 = b1;
+
+    return (a1 > a0) ? a1 - a0 : 0.0;
+}
+
+/* floor(v) clamped to [min, max], without converting out of range values */
+static inline int
+_echart_polyline_floor(double v, int min, int max)
+{
+    if (!(v > min))
+        return min;
+    if (v >= max)
+        return max;
+
+    return (int)floor(v);
+}
+
+/* the segment from (x0, y0) to (x1, y1) in the bands of the columns, with x0 <= x1 */
+static void
+_echart_polyline_segment_add(double *lo, double *hi, int w,
+                             double x0, double y0, double x1, double y1, double hw)
+{
+    double slope;
+    double ext;
+    int c0;
+    int c1;
+    int c;
+
+    /* the segments out of the columns are skipped */
+    if ((x1 < 0) || (x0 >= w))
+        return;
+
+    c0 = _echart_polyline_floor(x0, 0, w - 1);
+    c1 = _echart_polyline_floor(x1, 0, w - 1);
+
+    /*
+     * half the vertical thickness of the stroke, hw / cos(angle), bounded
+     * at 45 degrees as beyond the band is the y interval of the piece
+     */
+    slope = (x1 > x0) ? (y1 - y0) / (x1 - x0) : 0.0;
+    ext = (x1 > x0) ? hw * sqrt(1.0 + ((slope * slope < 1.0) ? slope * slope : 1.0)) : hw;
+
+    for (c = c0; c <= c1; c++)
+    {
+        double ya;
+        double yb;
+
+        /* the piece of the segment in the column */
+        if (x1 > x0)
+        {
+            ya = y0 + slope * (((x0 > c) ? x0 : c) - x0);
+            yb = y0 + slope * (((x1 < c + 1) ? x1 : c + 1) - x0);
+        }
+        else
+        {
+            ya = y0;
+            yb = y1;
+        }
+
+        if (ya > yb)
+        {
+            double tmp;
+
+            tmp = ya;
+            ya = yb;
+            yb = tmp;
+        }
+
+        if (lo[c] > ya - ext)
+            lo[c] = ya - ext;
+        if (hi[c] < yb + ext)
+            hi[c] = yb + ext;
+    }
+}
+
+/*
+ * Draws the polyline in the canvas, with a stroke of half weight hw and
+ * its color. Only the columns of the canvas covered by the stroke are
+ * computed. buffer is used as scratch memory.
+ */
+static Eina_Bool
+_echart_polyline_draw(Echart_Canvas *canvas, const Echart_Polyline *polyline, double hw, Echart_Buffer *buffer)
+{
+    const double *x;
+    const double *y;
+    double *lo;
+    double *hi;
+    double *lo_tmp;
+    double *hi_tmp;
+    double xmin;
+    double xmax;
+    unsigned int count;
+    unsigned int k;
+    int radius;
+    int bx;
+    int bw;
+    int x0;
+    int x1;
+    int c;
+    int i;
+
+    x = polyline->x;
+    y = polyline->y;
+    count = polyline->count;
+    if (!count)
+        return EINA_TRUE;
+
+    /* the columns of the stroke, in the canvas */
+    x0 = _echart_polyline_floor(polyline->xmin - hw, canvas->x, canvas->x + canvas->w);
+    x1 = _echart_polyline_floor(ceil(polyline->xmax + hw), canvas->x, canvas->x + canvas->w);
+    if (x0 >= x1)
+        return EINA_TRUE;
+
+    /*
+     * the bands are computed on the columns of the stroke and on the ones
+     * around them covered by the wide strokes, from bx
+     */
+    radius = (hw < ECHART_POLYLINE_RADIUS_MAX) ? (int)hw : ECHART_POLYLINE_RADIUS_MAX;
+    bx = x0 - radius;
+    bw = x1 - x0 + 2 * radius;
+    lo = echart_buffer_get(buffer, 4 * bw);
+    if (!lo)
+        return EINA_FALSE;
+    hi = lo + bw;
+    lo_tmp = hi + bw;
+    hi_tmp = lo_tmp + bw;
+
+    for (c = 0; c < bw; c++)
+    {
+        lo[c] = HUGE_VAL;
+        hi[c] = -HUGE_VAL;
+    }
+
+    /* the bands of the columns, in the coordinates of the canvas */
+    if (count == 1)
+        _echart_polyline_segment_add(lo, hi, bw,
+                                     x[0] - bx, y[0] - canvas->y,
+                                     x[0] - bx, y[0] - canvas->y, hw);
+    for (k = 1; k < count; k++)
+    {
+        if (x[k - 1] <= x[k])
+            _echart_polyline_segment_add(lo, hi, bw,
+                                         x[k - 1] - bx, y[k - 1] - canvas->y,
+                                         x[k] - bx, y[k] - canvas->y, hw);
+        else
+            _echart_polyline_segment_add(lo, hi, bw,
+                                         x[k] - bx, y[k] - canvas->y,
+                                         x[k - 1] - bx, y[k - 1] - canvas->y, hw);
+    }
+
+    /* the strokes wider than a pixel also cover the columns around */
+    for (; radius > 0; radius--)
+    {
+        double *tmp;
+
+        echart_simd_dilate(lo, hi, bw, lo_tmp, hi_tmp);
+        tmp = lo;
+        lo = lo_tmp;
+        lo_tmp = tmp;
+        tmp = hi;
+        hi = hi_tmp;
+        hi_tmp = tmp;
+    }
+
+    /*
+     * the coverage, the columns at the ends being partially covered. The
+     * pixels of a column are strided in the surface, so this loop is
+     * scalar: only the pixels at both ends of the band of a column are
+     * partially covered, the ones in between are blended with the
+     * coverage of the column.
+     */
+    xmin = polyline->xmin - hw - x0;
+    xmax = polyline->xmax + hw - x0;
+    lo += x0 - bx;
+    hi += x0 - bx;
+    for (c = 0; c < x1 - x0; c++)
+    {
+        uint32_t a;
+        double hc;
+        int cx;
+        int i0;
+        int i1;
+
+        if (lo[c] >= hi[c])
+            continue;
+
+        hc = _echart_polyline_overlap(xmin, xmax, c, c + 1);
+        i0 = _echart_polyline_floor(lo[c], 0, canvas->h);
+        i1 = _echart_polyline_floor(ceil(hi[c]), 0, canvas->h);
+        if (i0 >= i1)
+            continue;
+
+        cx = x0 - canvas->x + c;
+        if (i1 - i0 == 1)
+        {
+            a = (uint32_t)(hc * _echart_polyline_overlap(lo[c], hi[c], i0, i0 + 1) * 256 + 0.5);
+            echart_canvas_span_blend(canvas, cx, i0, 1, a, polyline->color);
+            continue;
+        }
+
+        a = (uint32_t)(hc * _echart_polyline_overlap(lo[c], hi[c], i0, i0 + 1) * 256 + 0.5);
+        echart_canvas_span_blend(canvas, cx, i0, 1, a, polyline->color);
+        a = (uint32_t)(hc * 256 + 0.5);
+        for (i = i0 + 1; i < i1 - 1; i++)
+            echart_canvas_span_blend(canvas, cx, i, 1, a, polyline->color);
+        a = (uint32_t)(hc * _echart_polyline_overlap(lo[c], hi[c], i1 - 1, i1) * 256 + 0.5);
+        echart_canvas_span_blend(canvas, cx, i1 - 1, 1, a, polyline->color);
+    }
+
+    return EINA_TRUE;
+}
+
+/**
+ * @endcond
+ */
+
+/*============================================================================*
+ *                                 Global                                     *
+ *============================================================================*/
+
+Echart_Polylines *
+echart_polylines_new(void)
+{
+    Echart_Polylines *polylines;
+
+    polylines = (Echart_Polylines *)calloc(1, sizeof(Echart_Polylines));
+    if (!polylines)
+        return NULL;
+
+    if (!echart_canvas_init(&polylines->canvas))
+    {
+        free(polylines);
+        return NULL;
+    }
+
+    polylines->dirty = 1;
+
+    return polylines;
+}
+
+void
+echart_polylines_free(Echart_Polylines *polylines)
+{
+    if (!polylines)
+        return;
+
+    echart_polylines_count_set(polylines, 0);
+    echart_canvas_shutdown(&polylines->canvas);
+    free(polylines);
+}
+
+/* the number of polylines, the new ones being empty */
+Eina_Bool
+echart_polylines_count_set(Echart_Polylines *polylines, unsigned int count)
+{
+    Echart_Polyline *tmp;
+    unsigned int s;
+
+    if (count == polylines->count)
+        return EINA_TRUE;
+
+    for (s = count; s < polylines->count; s++)
+    {
+        free(polylines->polylines[s].x);
+        free(polylines->polylines[s].y);
+    }
+    if (count < polylines->count)
+        polylines->count = count;
+
+    if (!count)
+    {
+        free(polylines->polylines);
+        polylines->polylines = NULL;
+        polylines->dirty = 1;
+        return EINA_TRUE;
+    }
+
+    tmp = (Echart_Polyline *)realloc(polylines->polylines, count * sizeof(Echart_Polyline));
+    if (!tmp)
+        return EINA_FALSE;
+
+    if (count > polylines->count)
+        memset(tmp + polylines->count, 0, (count - polylines->count) * sizeof(Echart_Polyline));
+    polylines->polylines = tmp;
+    polylines->count = count;
+    polylines->dirty = 1;
+
+    return EINA_TRUE;
+}
+
+/*
+ * the polyline s through the n points (x[k], y[k]), in the coordinates of
+ * the chart. The points are copied. Nothing is drawn if a point is not
+ * finite.
+ */
+Eina_Bool
+echart_polylines_set(Echart_Polylines *polylines, unsigned int s, const double *x, const double *y, unsigned int n)
+{
+    Echart_Polyline *polyline;
+
+    polyline = polylines->polylines + s;
+    polylines->dirty = 1;
+    polyline->count = 0;
+    if (!n)
+        return EINA_TRUE;
+
+    echart_simd_interval_get(x, n, &polyline->xmin, &polyline->xmax);
+    echart_simd_interval_get(y, n, &polyline->ymin, &polyline->ymax);
+    if (!isfinite(polyline->xmin) || !isfinite(polyline->xmax) ||
+        !isfinite(polyline->ymin) || !isfinite(polyline->ymax))
+        return EINA_TRUE;
+
+    if (n > polyline->alloc)
+    {
+        double *tmp;
+
+        tmp = (double *)realloc(polyline->x, n * sizeof(double));
+        if (!tmp)
+            return EINA_FALSE;
+        polyline->x = tmp;
+
+        tmp = (double *)realloc(polyline->y, n * sizeof(double));
+        if (!tmp)
+            return EINA_FALSE;
+        polyline->y = tmp;
+        polyline->alloc = n;
+    }
+
+    memcpy(polyline->x, x, n * sizeof(double));
+    memcpy(polyline->y, y, n * sizeof(double));
+    polyline->count = n;
+
+    return EINA_TRUE;
+}
+
+/* the color of the polyline s, premultiplied */
+void
+echart_polylines_color_set(Echart_Polylines *polylines, unsigned int s, Enesim_Color color)
+{
+    if (polylines->polylines[s].color == color)
+        return;
+
+    polylines->polylines[s].color = color;
+    polylines->dirty = 1;
+}
+
+/*
+ * Draws the polylines with a stroke of the given weight, in a canvas
+ * covering them inside the clip rectangle, if they, the weight or the
+ * clip rectangle changed since the last update. The canvas is kept
+ * between the updates while its size does not change.
+ */
+Eina_Bool
+echart_polylines_update(Echart_Polylines *polylines, double weight, const Eina_Rectangle *clip)
+{
+    Echart_Buffer buffer = { NULL, 0 };
+    Echart_Canvas *canvas;
+    double xmin;
+    double xmax;
+    double ymin;
+    double ymax;
+    double hw;
+    double margin;
+    unsigned int s;
+    int x0;
+    int y0;
+    int x1;
+    int y1;
+
+    if (!polylines->dirty && (polylines->weight == weight) &&
+        (polylines->clip.x == clip->x) && (polylines->clip.y == clip->y) &&
+        (polylines->clip.w == clip->w) && (polylines->clip.h == clip->h))
+        return EINA_TRUE;
+
+    xmin = ymin = HUGE_VAL;
+    xmax = ymax = -HUGE_VAL;
+    for (s = 0; s < polylines->count; s++)
+    {
+        const Echart_Polyline *polyline;
+
+        polyline = polylines->polylines + s;
+        if (!polyline->count)
+            continue;
+
+        if (xmin > polyline->xmin)
+            xmin = polyline->xmin;
+        if (xmax < polyline->xmax)
+            xmax = polyline->xmax;
+        if (ymin > polyline->ymin)
+            ymin = polyline->ymin;
+        if (ymax < polyline->ymax)
+            ymax = polyline->ymax;
+    }
+
+    /* the box of the strokes, in the clip rectangle */
+    x0 = y0 = x1 = y1 = 0;
+    hw = weight / 2.0;
+    if (xmin <= xmax)
+    {
+        margin = hw * M_SQRT2;
+        x0 = _echart_polyline_floor(xmin - hw, clip->x, clip->x + clip->w);
+        x1 = _echart_polyline_floor(ceil(xmax + hw), clip->x, clip->x + clip->w);
+        y0 = _echart_polyline_floor(ymin - margin, clip->y, clip->y + clip->h);
+        y1 = _echart_polyline_floor(ceil(ymax + margin), clip->y, clip->y + clip->h);
+    }
+
+    canvas = &polylines->canvas;
+    if (!echart_canvas_begin(canvas, x0, y0, x1 - x0, y1 - y0))
+        return EINA_FALSE;
+
+    for (s = 0; (s < polylines->count) && canvas->pixels; s++)
+    {
+        if (!_echart_polyline_draw(canvas, polylines->polylines + s, hw, &buffer))
+        {
+            echart_canvas_end(canvas);
+            echart_buffer_free(&buffer);
+            return EINA_FALSE;
+        }
+    }
+
+    echart_canvas_end(canvas);
+    echart_buffer_free(&buffer);
+
+    polylines->weight = weight;
+    polylines->clip = *clip;
+    polylines->dirty = 0;
+
+    return EINA_TRUE;
+}
+
+/* the renderer is owned by the polylines, a reference must be taken to keep it */
+Enesim_Renderer *
+echart_polylines_renderer_get(const Echart_Polylines *polylines)
+{
+    return polylines->canvas.renderer;
+}
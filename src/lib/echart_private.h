@@ -51,8 +51,250 @@ extern int echart_log_dom_global;
 #endif
 #define CRIT(...) EINA_LOG_DOM_CRIT(echart_log_dom_global, __VA_ARGS__)
 
-extern Echart_Colors echart_chart_default_colors[20];
+typedef struct _Echart_Buffer Echart_Buffer;
+typedef struct _Echart_Lod Echart_Lod;
+typedef struct _Echart_Arena Echart_Arena;
+typedef struct _Echart_Codec Echart_Codec;
+typedef struct _Echart_Shared Echart_Shared;
+typedef struct _Echart_Shared_Buffer Echart_Shared_Buffer;
 
-Echart_Data *echart_data_stacked_get(const Echart_Data *data);
+/* scratch memory, grown on demand */
+struct _Echart_Buffer
+{
+    double *data;
+    unsigned int size;
+};
+
+/*
+ * generations are compared modulo 2^32, so that the counters can wrap.
+ * Objects start at generation 1, 0 meaning that nothing has been seen yet
+ */
+#define ECHART_GENERATION_AFTER(g1, g2) ((int)((unsigned int)(g1) - (unsigned int)(g2)) > 0)
+
+#define ECHART_CHANGE_KINDS 7
+
+typedef struct _Echart_Generation Echart_Generation;
+
+/* generation of an object and generation of its last change of each kind */
+struct _Echart_Generation
+{
+    unsigned int current;
+    unsigned int changes[ECHART_CHANGE_KINDS];
+};
+
+void echart_generation_init(Echart_Generation *generation);
+void echart_generation_bump(Echart_Generation *generation, Echart_Change change);
+Echart_Change echart_generation_changes_get(const Echart_Generation *generation, unsigned int since);
+
+Echart_Colors echart_chart_default_colors_get(unsigned int idx);
+
+unsigned int echart_axis_ticks_get(double vmin, double vmax, unsigned int max, double *first, double *step);
+int echart_axis_decimals_get(double step);
+
+/* the glyphs of the numeric labels, side by side */
+#define ECHART_FONT_ATLAS_GLYPHS "0123456789-+.e,"
+#define ECHART_FONT_ATLAS_COUNT 15
+
+typedef struct _Echart_Font_Atlas Echart_Font_Atlas;
+
+struct _Echart_Font_Atlas
+{
+    Enesim_Surface *surface;
+    /* premultiplied ARGB pixels of the surface */
+    const uint32_t *pixels;
+    size_t stride;
+    int x[ECHART_FONT_ATLAS_COUNT];
+    int w[ECHART_FONT_ATLAS_COUNT];
+    int h;
+};
+
+Eina_Bool echart_font_init(void);
+void echart_font_shutdown(void);
+Enesim_Text_Font *echart_font_get(const char *family, int size);
+const Echart_Font_Atlas *echart_font_atlas_get(const char *family, int size);
+
+/* a * c, c being a premultiplied ARGB color and a in [0, 256] */
+#define ECHART_ARGB_MUL_256(a, c) \
+    (((((((c) >> 8) & 0x00ff00ff) * (a)) & 0xff00ff00)) + \
+     (((((c) & 0x00ff00ff) * (a)) >> 8) & 0x00ff00ff))
+
+typedef struct _Echart_Canvas Echart_Canvas;
+
+struct _Echart_Canvas
+{
+    Enesim_Renderer *renderer;
+    Enesim_Surface *surface;
+    /* premultiplied ARGB pixels, set between begin and end */
+    uint32_t *pixels;
+    size_t stride;
+    int x;
+    int y;
+    int w;
+    int h;
+};
+
+Eina_Bool echart_canvas_init(Echart_Canvas *canvas);
+void echart_canvas_shutdown(Echart_Canvas *canvas);
+Eina_Bool echart_canvas_begin(Echart_Canvas *canvas, int x, int y, int w, int h);
+void echart_canvas_end(Echart_Canvas *canvas);
+void echart_canvas_span_blend(Echart_Canvas *canvas, int x, int y, int len, uint32_t a, Enesim_Color color);
+
+void echart_grid_vline_add(Echart_Canvas *canvas, double x, double y0, double y1, Enesim_Color color, Eina_Bool dashed);
+void echart_grid_hline_add(Echart_Canvas *canvas, double y, double x0, double x1, Enesim_Color color, Eina_Bool dashed);
+
+typedef struct _Echart_Polylines Echart_Polylines;
+
+Echart_Polylines *echart_polylines_new(void);
+void echart_polylines_free(Echart_Polylines *polylines);
+Eina_Bool echart_polylines_count_set(Echart_Polylines *polylines, unsigned int count);
+Eina_Bool echart_polylines_set(Echart_Polylines *polylines, unsigned int s, const double *x, const double *y, unsigned int n);
+void echart_polylines_color_set(Echart_Polylines *polylines, unsigned int s, Enesim_Color color);
+Eina_Bool echart_polylines_update(Echart_Polylines *polylines, double weight, const Eina_Rectangle *clip);
+Enesim_Renderer *echart_polylines_renderer_get(const Echart_Polylines *polylines);
+
+typedef struct _Echart_Areas Echart_Areas;
+
+Echart_Areas *echart_areas_new(void);
+void echart_areas_free(Echart_Areas *areas);
+Eina_Bool echart_areas_count_set(Echart_Areas *areas, unsigned int count);
+Eina_Bool echart_areas_set(Echart_Areas *areas, unsigned int s, const double *x, const double *y, unsigned int n, double base, double x0, double x1);
+void echart_areas_color_set(Echart_Areas *areas, unsigned int s, Enesim_Color color);
+Eina_Bool echart_areas_update(Echart_Areas *areas);
+Enesim_Renderer *echart_areas_renderer_get(const Echart_Areas *areas);
+
+typedef struct _Echart_Bars Echart_Bars;
+
+Echart_Bars *echart_bars_new(void);
+void echart_bars_free(Echart_Bars *bars);
+void echart_bars_clear(Echart_Bars *bars);
+Eina_Bool echart_bars_palette_set(Echart_Bars *bars, const Enesim_Color *colors, unsigned int count);
+Eina_Bool echart_bars_add(Echart_Bars *bars, double x, double w, double y0, double y1, unsigned int color);
+Eina_Bool echart_bars_update(Echart_Bars *bars);
+Enesim_Renderer *echart_bars_renderer_get(const Echart_Bars *bars);
+
+typedef struct _Echart_Labels Echart_Labels;
+
+void echart_label_format(char *buf, size_t size, double value, int decimals);
+int echart_label_width_get(const Echart_Font_Atlas *atlas, const char *text);
+Echart_Labels *echart_labels_new(const char *family, int size);
+void echart_labels_free(Echart_Labels *labels);
+void echart_labels_clear(Echart_Labels *labels);
+int echart_labels_width_get(const Echart_Labels *labels, const char *text);
+int echart_labels_height_get(const Echart_Labels *labels);
+Eina_Bool echart_labels_add(Echart_Labels *labels, const char *text, int x, int y);
+Eina_Bool echart_labels_update(Echart_Labels *labels);
+Enesim_Renderer *echart_labels_renderer_get(const Echart_Labels *labels);
+
+double *echart_buffer_get(Echart_Buffer *buffer, unsigned int size);
+void echart_buffer_free(Echart_Buffer *buffer);
+
+/*
+ * the conversions of doubles to the integer types of the values: rounded to
+ * the nearest, halfway cases away from zero, clamped to the range of the
+ * type, NaN being converted to 0
+ */
+static inline int32_t
+echart_value_int32_get(double v)
+{
+    if (v != v)
+        return 0;
+    if (v <= (double)INT32_MIN)
+        return INT32_MIN;
+    if (v >= (double)INT32_MAX)
+        return INT32_MAX;
+    return (int32_t)((v < 0) ? v - 0.5 : v + 0.5);
+}
+
+static inline int64_t
+echart_value_int64_get(double v)
+{
+    if (v != v)
+        return 0;
+    /* -2^63 and 2^63, INT64_MAX not being representable as a double */
+    if (v <= -9223372036854775808.0)
+        return INT64_MIN;
+    if (v >= 9223372036854775808.0)
+        return INT64_MAX;
+    return (int64_t)((v < 0) ? v - 0.5 : v + 0.5);
+}
+
+/* count of values fetched at once by the readers of the items, a block of the codec */
+#define ECHART_DATA_FETCH_COUNT 1024
+
+/* count of values from idx to the end of its block, or to end */
+static inline unsigned int
+echart_data_fetch_count(unsigned int idx, unsigned int end)
+{
+    unsigned int n;
+
+    n = ECHART_DATA_FETCH_COUNT - (idx & (ECHART_DATA_FETCH_COUNT - 1));
+    return (n < end - idx) ? n : end - idx;
+}
+
+const double *echart_data_item_values_fetch(const Echart_Data_Item *item, unsigned int start, unsigned int count, Echart_Buffer *buffer);
+void echart_data_item_values_transform(const Echart_Data_Item *item, unsigned int start, unsigned int count, double offset, double scale, double *res);
+void echart_data_item_values_gather(const Echart_Data_Item *item, unsigned int start, const unsigned int *indices, unsigned int count, double *res);
+
+Echart_Arena *echart_arena_new(size_t size_hint);
+void echart_arena_free(Echart_Arena *arena);
+void *echart_arena_alloc(Echart_Arena *arena, size_t size);
+void *echart_arena_realloc(Echart_Arena *arena, void *ptr, size_t old_size, size_t size);
+char *echart_arena_strdup(Echart_Arena *arena, const char *str);
+
+Echart_Codec *echart_codec_new(Echart_Value_Type type);
+void echart_codec_free(Echart_Codec *codec);
+unsigned int echart_codec_count(const Echart_Codec *codec);
+size_t echart_codec_size(const Echart_Codec *codec);
+Eina_Bool echart_codec_append(Echart_Codec *codec, const double *values, unsigned int count);
+void echart_codec_decode(const Echart_Codec *codec, unsigned int start, unsigned int count, double *res);
+double echart_codec_value_get(const Echart_Codec *codec, unsigned int idx);
+void echart_codec_gather(const Echart_Codec *codec, unsigned int start, const unsigned int *indices, unsigned int count, double *res);
+unsigned int echart_codec_lower_bound(const Echart_Codec *codec, double x, Eina_Bool strict);
+void echart_codec_interval_get(const Echart_Codec *codec, unsigned int start, unsigned int end, double *vmin, double *vmax);
+
+Echart_Shared *echart_shared_new(void);
+void echart_shared_free(Echart_Shared *shared);
+Eina_Bool echart_shared_readers_get(const Echart_Shared *shared);
+unsigned int echart_shared_read_lock(Echart_Shared *shared);
+void echart_shared_read_unlock(Echart_Shared *shared, unsigned int slot);
+void echart_shared_reclaim(Echart_Shared *shared);
+Echart_Shared_Buffer *echart_shared_buffer_new(size_t size);
+void echart_shared_buffer_free(Echart_Shared_Buffer *buffer);
+unsigned char *echart_shared_buffer_values_get(const Echart_Shared_Buffer *buffer);
+void echart_shared_buffer_publish(Echart_Shared_Buffer *buffer, unsigned int count);
+unsigned int echart_shared_buffer_count_get(const Echart_Shared_Buffer *buffer);
+void echart_shared_buffer_replace(Echart_Shared *shared, Echart_Shared_Buffer **slot, Echart_Shared_Buffer *buffer);
+Echart_Shared_Buffer *echart_shared_buffer_get(Echart_Shared_Buffer *const *slot);
+
+void echart_simd_init(void);
+void echart_simd_interval_get(const double *values, unsigned int count, double *vmin, double *vmax);
+double echart_simd_sum(const double *values, unsigned int count);
+void echart_simd_transform(const double *values, unsigned int count, double offset, double scale, double *res);
+void echart_simd_interval_typed_get(const void *values, Echart_Value_Type type, unsigned int count, double *vmin, double *vmax);
+void echart_simd_transform_typed(const void *values, Echart_Value_Type type, unsigned int count, double offset, double scale, double *res);
+void echart_simd_dilate(const double *lo, const double *hi, unsigned int count, double *lo_res, double *hi_res);
+
+unsigned int echart_decimate_size(Echart_Decimation decimation, unsigned int count, unsigned int width);
+unsigned int echart_decimate(Echart_Decimation decimation, const Echart_Data_Item *absciss, const Echart_Data_Item *item, const double *stacked, unsigned int first, unsigned int count, double x_offset, double x_scale, unsigned int *indices, unsigned int size, Echart_Buffer *xbuffer, Echart_Buffer *ybuffer);
+
+/* log2 of the count of samples summarized by a bucket of the pyramid */
+#define ECHART_LOD_SHIFT 4
+
+Echart_Lod *echart_lod_new(void);
+void echart_lod_free(Echart_Lod *lod);
+void echart_lod_clear(Echart_Lod *lod);
+unsigned int echart_lod_count(const Echart_Lod *lod);
+void echart_lod_shared_set(Echart_Lod *lod, Echart_Shared *shared);
+Echart_Lod *echart_lod_view_new(const Echart_Lod *lod, unsigned int count);
+Eina_Bool echart_lod_view_get(const Echart_Lod *lod);
+Eina_Bool echart_lod_append(Echart_Lod *lod, const double *values, unsigned int count);
+Eina_Bool echart_lod_interval_get(const Echart_Lod *lod, unsigned int start, unsigned int end, double *vmin, double *vmax);
+unsigned int echart_lod_size(unsigned int width);
+unsigned int echart_lod_fetch(const Echart_Lod *lod, unsigned int start, unsigned int end, unsigned int width, unsigned int *indices, unsigned int size);
+
+void echart_data_item_range_find(const Echart_Data_Item *item, double xmin, double xmax, unsigned int *first, unsigned int *count);
+unsigned int echart_data_item_lod_fetch(const Echart_Data_Item *item, unsigned int start, unsigned int end, unsigned int width, unsigned int *indices, unsigned int size);
+Eina_Bool echart_data_stacked_update(const Echart_Data *data);
+const double *echart_data_stacked_values_get(const Echart_Data *data, unsigned int idx, unsigned int *count, double *vmin, double *vmax);
 
 #endif
@@ -0,0 +1,202 @@
+/* Echart - Chart rendering library
+ * Copyright (C) 2013 Vincent Torri
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <Enesim.h>
+
+#include "Echart.h"
+#include "echart_private.h"
+
+/*============================================================================*
+ *                                  Local                                     *
+ *============================================================================*/
+
+/**
+ * @cond LOCAL
+ */
+
+/* the height of the bands of rows given to the threads */
+#define ECHART_RENDER_BAND_ROWS 16
+
+/* the most threads drawing a scene */
+#define ECHART_RENDER_THREADS_MAX 64
+
+typedef struct _Echart_Render Echart_Render;
+
+/*
+ * A scene drawn in bands of rows. The renderer is set up once, its spans
+ * are then drawn by all the threads, each taking the next band left when
+ * it is done with its own, so that the threads drawing simple bands take
+ * more of them.
+ */
+struct _Echart_Render
+{
+    Enesim_Renderer *scene;
+    uint32_t *pixels;
+    size_t stride;
+    Eina_Rectangle area;
+    Eina_Lock lock;
+    unsigned int band;
+    unsigned int bands;
+};
+
+static void *
+_echart_render_bands_draw(void *data, Eina_Thread t EINA_UNUSED)
+{
+    Echart_Render *render;
+    unsigned int band;
+    int y0;
+    int y1;
+    int y;
+
+    render = (Echart_Render *)data;
+    for (;;)
+    {
+        eina_lock_take(&render->lock);
+        band = render->band++;
+        eina_lock_release(&render->lock);
+        if (band >= render->bands)
+            break;
+
+        y0 = render->area.y + band * ECHART_RENDER_BAND_ROWS;
+        y1 = y0 + ECHART_RENDER_BAND_ROWS;
+        if (y1 > render->area.y + render->area.h)
+            y1 = render->area.y + render->area.h;
+
+        for (y = y0; y < y1; y++)
+        {
+            uint32_t *dst;
+
+            dst = (uint32_t *)((unsigned char *)render->pixels + y * render->stride) + render->area.x;
+            enesim_renderer_sw_draw(render->scene, render->area.x, y, render->area.w, dst);
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * @endcond
+ */
+
+/*============================================================================*
+ *                                 Global                                     *
+ *============================================================================*/
+
+/*============================================================================*
+ *                                   API                                      *
+ *============================================================================*/
+
+/*
+ * Draws the scene in the surface, like enesim_renderer_draw() with the
+ * fill operation, with n_threads threads, the calling one included, 0
+ * meaning one thread per CPU. Each row of pixels is drawn by a single
+ * thread the same way whatever their number, so the result does not
+ * depend on it.
+ *
+ * The scene is set up and cleaned up once, on the calling thread, the
+ * threads only drawing spans of the set up renderer, the way the own
+ * threads of Enesim do. Only this drawing of the layers of the scene in
+ * the surface is done in parallel. The lines and the areas are
+ * rasterized in their canvases by echart_line_update(), on the calling
+ * thread, before.
+ */
+EAPI Eina_Bool
+echart_render(Enesim_Renderer *scene, Enesim_Surface *surface, unsigned int n_threads)
+{
+    Echart_Render render;
+    Eina_Thread threads[ECHART_RENDER_THREADS_MAX];
+    Eina_Rectangle bounds;
+    void *data;
+    unsigned int started;
+    unsigned int i;
+    int w;
+    int h;
+
+    if (!scene || !surface)
+        return EINA_FALSE;
+
+    if (!n_threads)
+        n_threads = eina_cpu_count();
+    if (n_threads > ECHART_RENDER_THREADS_MAX)
+        n_threads = ECHART_RENDER_THREADS_MAX;
+
+    /* only the pixels of the scene are drawn */
+    enesim_surface_size_get(surface, &w, &h);
+    eina_rectangle_coords_from(&render.area, 0, 0, w, h);
+    if (!enesim_renderer_destination_bounds_get(scene, &bounds, 0, 0, NULL) ||
+        !eina_rectangle_intersection(&render.area, &bounds))
+        return EINA_TRUE;
+
+    if (!enesim_renderer_setup(scene, surface, ENESIM_ROP_FILL, NULL))
+    {
+        ERR("Could not set up the scene");
+        return EINA_FALSE;
+    }
+
+    if (!enesim_surface_lock(surface, EINA_TRUE))
+    {
+        enesim_renderer_cleanup(scene, surface);
+        return EINA_FALSE;
+    }
+
+    if (!enesim_surface_data_get(surface, &data, &render.stride))
+    {
+        enesim_surface_unlock(surface);
+        enesim_renderer_cleanup(scene, surface);
+        return EINA_FALSE;
+    }
+
+    if (!eina_lock_new(&render.lock))
+    {
+        enesim_surface_unlock(surface);
+        enesim_renderer_cleanup(scene, surface);
+        return EINA_FALSE;
+    }
+
+    render.scene = scene;
+    render.pixels = (uint32_t *)data;
+    render.band = 0;
+    render.bands = (render.area.h + ECHART_RENDER_BAND_ROWS - 1) / ECHART_RENDER_BAND_ROWS;
+    if (n_threads > render.bands)
+        n_threads = render.bands;
+
+    /* the bands are still all drawn if a thread can not be created */
+    started = 0;
+    for (i = 1; i < n_threads; i++)
+    {
+        if (!eina_thread_create(&threads[started], EINA_THREAD_NORMAL, -1,
+                                _echart_render_bands_draw, &render))
+            break;
+        started++;
+    }
+
+    _echart_render_bands_draw(&render, 0);
+
+    for (i = 0; i < started; i++)
+        eina_thread_join(threads[i]);
+
+    eina_lock_free(&render.lock);
+    enesim_surface_unlock(surface);
+    enesim_renderer_cleanup(scene, surface);
+
+    return EINA_TRUE;
+}
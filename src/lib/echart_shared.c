@@ -0,0 +1,229 @@
+/* Echart - Chart rendering library
+ * Copyright (C) 2013 Vincent Torri
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <Enesim.h>
+
+#include "Echart.h"
+#include "echart_private.h"
+
+/*============================================================================*
+ *                                  Local                                     *
+ *============================================================================*/
+
+/**
+ * @cond LOCAL
+ */
+
+/*
+ * A single writer appends values to buffers which are never moved: when a
+ * buffer is full, the writer copies it to a larger one, publishes the new
+ * one and retires the old one. The readers read the published count of
+ * values of a buffer, which only grows, so the values they read are never
+ * written again.
+ *
+ * The retired buffers are reclaimed with epochs: a reader registers itself
+ * in the counter of the current epoch for as long as it reads. The writer
+ * advances the epoch when no reader of the previous one is left, and frees
+ * a buffer retired during epoch e once the epoch reached e + 2, as all the
+ * readers which could have seen it are then gone. The writer never waits
+ * for the readers.
+ */
+#define ECHART_SHARED_ALIGN 16
+
+#define ECHART_SHARED_ROUND(s) (((s) + ECHART_SHARED_ALIGN - 1) & ~((size_t)ECHART_SHARED_ALIGN - 1))
+
+struct _Echart_Shared_Buffer
+{
+    /* next retired buffer */
+    Echart_Shared_Buffer *next;
+    /* count of published values, stored with release semantic */
+    unsigned int count;
+    /* epoch during which the buffer has been retired */
+    unsigned int epoch;
+};
+
+struct _Echart_Shared
+{
+    unsigned int epoch;
+    unsigned int readers[2];
+    /* only accessed by the writer */
+    Echart_Shared_Buffer *retired;
+};
+
+/**
+ * @endcond
+ */
+
+/*============================================================================*
+ *                                 Global                                     *
+ *============================================================================*/
+
+Echart_Shared *
+echart_shared_new(void)
+{
+    return (Echart_Shared *)calloc(1, sizeof(Echart_Shared));
+}
+
+/* no reader must be left */
+void
+echart_shared_free(Echart_Shared *shared)
+{
+    Echart_Shared_Buffer *buffer;
+
+    if (!shared)
+        return;
+
+    buffer = shared->retired;
+    while (buffer)
+    {
+        Echart_Shared_Buffer *next;
+
+        next = buffer->next;
+        free(buffer);
+        buffer = next;
+    }
+    free(shared);
+}
+
+Eina_Bool
+echart_shared_readers_get(const Echart_Shared *shared)
+{
+    return (__atomic_load_n(&shared->readers[0], __ATOMIC_SEQ_CST) ||
+            __atomic_load_n(&shared->readers[1], __ATOMIC_SEQ_CST));
+}
+
+/*
+ * The reader registers itself in the current epoch, checking that it has not
+ * been advanced meanwhile, in which case the writer may not have seen the
+ * registration.
+ */
+unsigned int
+echart_shared_read_lock(Echart_Shared *shared)
+{
+    unsigned int epoch;
+
+    for (;;)
+    {
+        epoch = __atomic_load_n(&shared->epoch, __ATOMIC_SEQ_CST);
+        __atomic_add_fetch(&shared->readers[epoch & 1], 1, __ATOMIC_SEQ_CST);
+        if (__atomic_load_n(&shared->epoch, __ATOMIC_SEQ_CST) == epoch)
+            return epoch & 1;
+        __atomic_sub_fetch(&shared->readers[epoch & 1], 1, __ATOMIC_SEQ_CST);
+    }
+}
+
+void
+echart_shared_read_unlock(Echart_Shared *shared, unsigned int slot)
+{
+    __atomic_sub_fetch(&shared->readers[slot], 1, __ATOMIC_SEQ_CST);
+}
+
+/* called by the writer only */
+void
+echart_shared_reclaim(Echart_Shared *shared)
+{
+    Echart_Shared_Buffer **prev;
+    Echart_Shared_Buffer *buffer;
+    unsigned int epoch;
+    int i;
+
+    if (!shared->retired)
+        return;
+
+    /* at most 2 steps are needed to reclaim all the retired buffers */
+    epoch = shared->epoch;
+    for (i = 0; i < 2; i++)
+    {
+        if (__atomic_load_n(&shared->readers[(epoch + 1) & 1], __ATOMIC_SEQ_CST))
+            break;
+        epoch++;
+        __atomic_store_n(&shared->epoch, epoch, __ATOMIC_SEQ_CST);
+    }
+
+    prev = &shared->retired;
+    buffer = shared->retired;
+    while (buffer)
+    {
+        if (epoch - buffer->epoch >= 2)
+        {
+            *prev = buffer->next;
+            free(buffer);
+        }
+        else
+            prev = &buffer->next;
+        buffer = *prev;
+    }
+}
+
+Echart_Shared_Buffer *
+echart_shared_buffer_new(size_t size)
+{
+    return (Echart_Shared_Buffer *)calloc(1, ECHART_SHARED_ROUND(sizeof(Echart_Shared_Buffer)) + size);
+}
+
+void
+echart_shared_buffer_free(Echart_Shared_Buffer *buffer)
+{
+    free(buffer);
+}
+
+unsigned char *
+echart_shared_buffer_values_get(const Echart_Shared_Buffer *buffer)
+{
+    return (unsigned char *)buffer + ECHART_SHARED_ROUND(sizeof(Echart_Shared_Buffer));
+}
+
+/* the values of index lower than count must have been written */
+void
+echart_shared_buffer_publish(Echart_Shared_Buffer *buffer, unsigned int count)
+{
+    __atomic_store_n(&buffer->count, count, __ATOMIC_RELEASE);
+}
+
+unsigned int
+echart_shared_buffer_count_get(const Echart_Shared_Buffer *buffer)
+{
+    return __atomic_load_n(&buffer->count, __ATOMIC_ACQUIRE);
+}
+
+/* publishes buffer in place of the one in slot, which is retired */
+void
+echart_shared_buffer_replace(Echart_Shared *shared, Echart_Shared_Buffer **slot, Echart_Shared_Buffer *buffer)
+{
+    Echart_Shared_Buffer *old;
+
+    old = *slot;
+    __atomic_store_n(slot, buffer, __ATOMIC_RELEASE);
+    if (old)
+    {
+        old->epoch = shared->epoch;
+        old->next = shared->retired;
+        shared->retired = old;
+    }
+    echart_shared_reclaim(shared);
+}
+
+Echart_Shared_Buffer *
+echart_shared_buffer_get(Echart_Shared_Buffer *const *slot)
+{
+    return __atomic_load_n(slot, __ATOMIC_ACQUIRE);
+}
@@ -0,0 +1,760 @@
+/* Echart - Chart rendering library
+ * Copyright (C) 2013 Vincent Torri
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <Enesim.h>
+
+/*
+ * the vectorized kernels need the target attribute and the cpu detection
+ * builtins of gcc >= 4.9 or clang
+ */
+#if (defined(__x86_64__) || defined(__i386__)) && \
+    (defined(__clang__) || \
+     (defined(__GNUC__) && ((__GNUC__ > 4) || ((__GNUC__ == 4) && (__GNUC_MINOR__ >= 9)))))
+# define ECHART_SIMD_X86
+# include <immintrin.h>
+#endif
+
+#include "Echart.h"
+#include "echart_private.h"
+
+/*============================================================================*
+ *                                  Local                                     *
+ *============================================================================*/
+
+/**
+ * @cond LOCAL
+ */
+
+typedef void (*Echart_Simd_Interval)(const double *values, unsigned int count, double *vmin, double *vmax);
+typedef double (*Echart_Simd_Sum)(const double *values, unsigned int count);
+typedef void (*Echart_Simd_Transform)(const double *values, unsigned int count, double offset, double scale, double *res);
+typedef void (*Echart_Simd_Interval_Typed)(const void *values, unsigned int count, double *vmin, double *vmax);
+typedef void (*Echart_Simd_Transform_Typed)(const void *values, unsigned int count, double offset, double scale, double *res);
+typedef void (*Echart_Simd_Dilate)(const double *lo, const double *hi, unsigned int count, double *lo_res, double *hi_res);
+
+/*
+ * The narrower types are read natively: the interval is computed in the
+ * type of the values, and the transform converts them on the fly.
+ */
+#define ECHART_SIMD_TYPED_C(name, type)                                  \
+static void                                                             \
+_echart_simd_interval_##name##_c(const void *values, unsigned int count, \
+                                 double *vmin, double *vmax)            \
+{                                                                       \
+    const type *v;                                                      \
+    type min;                                                           \
+    type max;                                                           \
+    unsigned int i;                                                     \
+                                                                        \
+    v = (const type *)values;                                           \
+    min = max = v[0];                                                   \
+    for (i = 1; i < count; i++)                                         \
+    {                                                                   \
+        if (v[i] < min) min = v[i];                                     \
+        if (v[i] > max) max = v[i];                                     \
+    }                                                                   \
+                                                                        \
+    *vmin = (double)min;                                                \
+    *vmax = (double)max;                                                \
+}                                                                       \
+                                                                        \
+static void                                                             \
+_echart_simd_transform_##name##_c(const void *values, unsigned int count, \
+                                  double offset, double scale, double *res) \
+{                                                                       \
+    const type *v;                                                      \
+    unsigned int i;                                                     \
+                                                                        \
+    v = (const type *)values;                                           \
+    for (i = 0; i < count; i++)                                         \
+        res[i] = offset + scale * (double)v[i];                         \
+}
+
+ECHART_SIMD_TYPED_C(float, float)
+ECHART_SIMD_TYPED_C(int32, int32_t)
+ECHART_SIMD_TYPED_C(int64, int64_t)
+
+static void
+_echart_simd_interval_c(const double *values, unsigned int count, double *vmin, double *vmax)
+{
+    double min;
+    double max;
+    unsigned int i;
+
+    min = max = values[0];
+    for (i = 1; i < count; i++)
+    {
+        if (values[i] < min) min = values[i];
+        if (values[i] > max) max = values[i];
+    }
+
+    *vmin = min;
+    *vmax = max;
+}
+
+static double
+_echart_simd_sum_c(const double *values, unsigned int count)
+{
+    double sum;
+    unsigned int i;
+
+    sum = 0.0;
+    for (i = 0; i < count; i++)
+        sum += values[i];
+
+    return sum;
+}
+
+static void
+_echart_simd_transform_c(const double *values, unsigned int count, double offset, double scale, double *res)
+{
+    unsigned int i;
+
+    for (i = 0; i < count; i++)
+        res[i] = offset + scale * values[i];
+}
+
+/* the bounds of the first and the last elements, the others being done by the kernels */
+static void
+_echart_simd_dilate_bounds(const double *lo, const double *hi, unsigned int count, double *lo_res, double *hi_res)
+{
+    unsigned int i;
+
+    i = 0;
+    lo_res[i] = (lo[i + 1] < lo[i]) ? lo[i + 1] : lo[i];
+    hi_res[i] = (hi[i + 1] > hi[i]) ? hi[i + 1] : hi[i];
+    i = count - 1;
+    lo_res[i] = (lo[i - 1] < lo[i]) ? lo[i - 1] : lo[i];
+    hi_res[i] = (hi[i - 1] > hi[i]) ? hi[i - 1] : hi[i];
+}
+
+static void
+_echart_simd_dilate_c(const double *lo, const double *hi, unsigned int count, double *lo_res, double *hi_res)
+{
+    unsigned int i;
+
+    for (i = 1; i + 1 < count; i++)
+    {
+        double l;
+        double h;
+
+        l = lo[i];
+        if (lo[i - 1] < l) l = lo[i - 1];
+        if (lo[i + 1] < l) l = lo[i + 1];
+        h = hi[i];
+        if (hi[i - 1] > h) h = hi[i - 1];
+        if (hi[i + 1] > h) h = hi[i + 1];
+        lo_res[i] = l;
+        hi_res[i] = h;
+    }
+}
+
+#ifdef ECHART_SIMD_X86
+
+/*
+ * The lanes of the intervals start at the first value, and the value read
+ * is the first operand of min and max, which return their second one when
+ * an operand is NaN. So, as in the C version, the NaN values are ignored,
+ * except the first one, which is the result.
+ */
+
+__attribute__((target("sse2")))
+static void
+_echart_simd_interval_sse2(const double *values, unsigned int count, double *vmin, double *vmax)
+{
+    __m128d mn;
+    __m128d mx;
+    double tmin[2];
+    double tmax[2];
+    unsigned int i;
+
+    mn = mx = _mm_set1_pd(values[0]);
+    for (i = 1; i + 2 <= count; i += 2)
+    {
+        __m128d v;
+
+        v = _mm_loadu_pd(values + i);
+        mn = _mm_min_pd(v, mn);
+        mx = _mm_max_pd(v, mx);
+    }
+    _mm_storeu_pd(tmin, mn);
+    _mm_storeu_pd(tmax, mx);
+
+    if (tmin[1] < tmin[0]) tmin[0] = tmin[1];
+    if (tmax[1] > tmax[0]) tmax[0] = tmax[1];
+    for (; i < count; i++)
+    {
+        if (values[i] < tmin[0]) tmin[0] = values[i];
+        if (values[i] > tmax[0]) tmax[0] = values[i];
+    }
+
+    *vmin = tmin[0];
+    *vmax = tmax[0];
+}
+
+__attribute__((target("sse2")))
+static double
+_echart_simd_sum_sse2(const double *values, unsigned int count)
+{
+    __m128d s;
+    double t[2];
+    unsigned int i;
+
+    s = _mm_setzero_pd();
+    for (i = 0; i + 2 <= count; i += 2)
+        s = _mm_add_pd(s, _mm_loadu_pd(values + i));
+    _mm_storeu_pd(t, s);
+
+    t[0] += t[1];
+    for (; i < count; i++)
+        t[0] += values[i];
+
+    return t[0];
+}
+
+__attribute__((target("sse2")))
+static void
+_echart_simd_transform_sse2(const double *values, unsigned int count, double offset, double scale, double *res)
+{
+    __m128d o;
+    __m128d s;
+    unsigned int i;
+
+    o = _mm_set1_pd(offset);
+    s = _mm_set1_pd(scale);
+    for (i = 0; i + 2 <= count; i += 2)
+        _mm_storeu_pd(res + i, _mm_add_pd(o, _mm_mul_pd(s, _mm_loadu_pd(values + i))));
+
+    for (; i < count; i++)
+        res[i] = offset + scale * values[i];
+}
+
+__attribute__((target("sse2")))
+static void
+_echart_simd_transform_float_sse2(const void *values, unsigned int count, double offset, double scale, double *res)
+{
+    const float *v;
+    __m128d o;
+    __m128d s;
+    unsigned int i;
+
+    v = (const float *)values;
+    o = _mm_set1_pd(offset);
+    s = _mm_set1_pd(scale);
+    for (i = 0; i + 2 <= count; i += 2)
+    {
+        __m128d d;
+
+        d = _mm_cvtps_pd(_mm_castpd_ps(_mm_load_sd((const double *)(v + i))));
+        _mm_storeu_pd(res + i, _mm_add_pd(o, _mm_mul_pd(s, d)));
+    }
+
+    for (; i < count; i++)
+        res[i] = offset + scale * (double)v[i];
+}
+
+__attribute__((target("sse2")))
+static void
+_echart_simd_transform_int32_sse2(const void *values, unsigned int count, double offset, double scale, double *res)
+{
+    const int32_t *v;
+    __m128d o;
+    __m128d s;
+    unsigned int i;
+
+    v = (const int32_t *)values;
+    o = _mm_set1_pd(offset);
+    s = _mm_set1_pd(scale);
+    for (i = 0; i + 2 <= count; i += 2)
+    {
+        __m128d d;
+
+        d = _mm_cvtepi32_pd(_mm_loadl_epi64((const __m128i *)(v + i)));
+        _mm_storeu_pd(res + i, _mm_add_pd(o, _mm_mul_pd(s, d)));
+    }
+
+    for (; i < count; i++)
+        res[i] = offset + scale * (double)v[i];
+}
+
+__attribute__((target("sse2")))
+static void
+_echart_simd_interval_float_sse2(const void *values, unsigned int count, double *vmin, double *vmax)
+{
+    const float *v;
+    __m128 mn;
+    __m128 mx;
+    float tmin[4];
+    float tmax[4];
+    unsigned int i;
+    unsigned int k;
+
+    v = (const float *)values;
+    mn = mx = _mm_set1_ps(v[0]);
+    for (i = 1; i + 4 <= count; i += 4)
+    {
+        __m128 x;
+
+        x = _mm_loadu_ps(v + i);
+        mn = _mm_min_ps(x, mn);
+        mx = _mm_max_ps(x, mx);
+    }
+    _mm_storeu_ps(tmin, mn);
+    _mm_storeu_ps(tmax, mx);
+
+    for (k = 1; k < 4; k++)
+    {
+        if (tmin[k] < tmin[0]) tmin[0] = tmin[k];
+        if (tmax[k] > tmax[0]) tmax[0] = tmax[k];
+    }
+    for (; i < count; i++)
+    {
+        if (v[i] < tmin[0]) tmin[0] = v[i];
+        if (v[i] > tmax[0]) tmax[0] = v[i];
+    }
+
+    *vmin = (double)tmin[0];
+    *vmax = (double)tmax[0];
+}
+
+/* SSE2 has no min and max of 32 bits integers, they are exact in doubles */
+__attribute__((target("sse2")))
+static void
+_echart_simd_interval_int32_sse2(const void *values, unsigned int count, double *vmin, double *vmax)
+{
+    const int32_t *v;
+    __m128d mn;
+    __m128d mx;
+    double tmin[2];
+    double tmax[2];
+    unsigned int i;
+
+    v = (const int32_t *)values;
+    mn = mx = _mm_set1_pd((double)v[0]);
+    for (i = 1; i + 4 <= count; i += 4)
+    {
+        __m128i x;
+        __m128d lo;
+        __m128d hi;
+
+        x = _mm_loadu_si128((const __m128i *)(v + i));
+        lo = _mm_cvtepi32_pd(x);
+        hi = _mm_cvtepi32_pd(_mm_srli_si128(x, 8));
+        mn = _mm_min_pd(mn, _mm_min_pd(lo, hi));
+        mx = _mm_max_pd(mx, _mm_max_pd(lo, hi));
+    }
+    _mm_storeu_pd(tmin, mn);
+    _mm_storeu_pd(tmax, mx);
+
+    if (tmin[1] < tmin[0]) tmin[0] = tmin[1];
+    if (tmax[1] > tmax[0]) tmax[0] = tmax[1];
+    for (; i < count; i++)
+    {
+        if (v[i] < tmin[0]) tmin[0] = (double)v[i];
+        if (v[i] > tmax[0]) tmax[0] = (double)v[i];
+    }
+
+    *vmin = tmin[0];
+    *vmax = tmax[0];
+}
+
+__attribute__((target("sse2")))
+static void
+_echart_simd_dilate_sse2(const double *lo, const double *hi, unsigned int count, double *lo_res, double *hi_res)
+{
+    unsigned int i;
+
+    for (i = 1; i + 3 <= count; i += 2)
+    {
+        __m128d l;
+        __m128d h;
+
+        l = _mm_min_pd(_mm_min_pd(_mm_loadu_pd(lo + i - 1), _mm_loadu_pd(lo + i)), _mm_loadu_pd(lo + i + 1));
+        h = _mm_max_pd(_mm_max_pd(_mm_loadu_pd(hi + i - 1), _mm_loadu_pd(hi + i)), _mm_loadu_pd(hi + i + 1));
+        _mm_storeu_pd(lo_res + i, l);
+        _mm_storeu_pd(hi_res + i, h);
+    }
+
+    _echart_simd_dilate_c(lo + i - 1, hi + i - 1, count - i + 1, lo_res + i - 1, hi_res + i - 1);
+}
+
+__attribute__((target("avx2")))
+static void
+_echart_simd_interval_avx2(const double *values, unsigned int count, double *vmin, double *vmax)
+{
+    __m256d mn;
+    __m256d mx;
+    double tmin[4];
+    double tmax[4];
+    unsigned int i;
+    unsigned int k;
+
+    mn = mx = _mm256_set1_pd(values[0]);
+    for (i = 1; i + 4 <= count; i += 4)
+    {
+        __m256d v;
+
+        v = _mm256_loadu_pd(values + i);
+        mn = _mm256_min_pd(v, mn);
+        mx = _mm256_max_pd(v, mx);
+    }
+    _mm256_storeu_pd(tmin, mn);
+    _mm256_storeu_pd(tmax, mx);
+
+    for (k = 1; k < 4; k++)
+    {
+        if (tmin[k] < tmin[0]) tmin[0] = tmin[k];
+        if (tmax[k] > tmax[0]) tmax[0] = tmax[k];
+    }
+    for (; i < count; i++)
+    {
+        if (values[i] < tmin[0]) tmin[0] = values[i];
+        if (values[i] > tmax[0]) tmax[0] = values[i];
+    }
+
+    *vmin = tmin[0];
+    *vmax = tmax[0];
+}
+
+__attribute__((target("avx2")))
+static double
+_echart_simd_sum_avx2(const double *values, unsigned int count)
+{
+    __m256d s;
+    double t[4];
+    unsigned int i;
+
+    s = _mm256_setzero_pd();
+    for (i = 0; i + 4 <= count; i += 4)
+        s = _mm256_add_pd(s, _mm256_loadu_pd(values + i));
+    _mm256_storeu_pd(t, s);
+
+    t[0] += t[1] + t[2] + t[3];
+    for (; i < count; i++)
+        t[0] += values[i];
+
+    return t[0];
+}
+
+__attribute__((target("avx2")))
+static void
+_echart_simd_transform_avx2(const double *values, unsigned int count, double offset, double scale, double *res)
+{
+    __m256d o;
+    __m256d s;
+    unsigned int i;
+
+    o = _mm256_set1_pd(offset);
+    s = _mm256_set1_pd(scale);
+    for (i = 0; i + 4 <= count; i += 4)
+        _mm256_storeu_pd(res + i, _mm256_add_pd(o, _mm256_mul_pd(s, _mm256_loadu_pd(values + i))));
+
+    for (; i < count; i++)
+        res[i] = offset + scale * values[i];
+}
+
+__attribute__((target("avx2")))
+static void
+_echart_simd_transform_float_avx2(const void *values, unsigned int count, double offset, double scale, double *res)
+{
+    const float *v;
+    __m256d o;
+    __m256d s;
+    unsigned int i;
+
+    v = (const float *)values;
+    o = _mm256_set1_pd(offset);
+    s = _mm256_set1_pd(scale);
+    for (i = 0; i + 4 <= count; i += 4)
+    {
+        __m256d d;
+
+        d = _mm256_cvtps_pd(_mm_loadu_ps(v + i));
+        _mm256_storeu_pd(res + i, _mm256_add_pd(o, _mm256_mul_pd(s, d)));
+    }
+
+    for (; i < count; i++)
+        res[i] = offset + scale * (double)v[i];
+}
+
+__attribute__((target("avx2")))
+static void
+_echart_simd_transform_int32_avx2(const void *values, unsigned int count, double offset, double scale, double *res)
+{
+    const int32_t *v;
+    __m256d o;
+    __m256d s;
+    unsigned int i;
+
+    v = (const int32_t *)values;
+    o = _mm256_set1_pd(offset);
+    s = _mm256_set1_pd(scale);
+    for (i = 0; i + 4 <= count; i += 4)
+    {
+        __m256d d;
+
+        d = _mm256_cvtepi32_pd(_mm_loadu_si128((const __m128i *)(v + i)));
+        _mm256_storeu_pd(res + i, _mm256_add_pd(o, _mm256_mul_pd(s, d)));
+    }
+
+    for (; i < count; i++)
+        res[i] = offset + scale * (double)v[i];
+}
+
+__attribute__((target("avx2")))
+static void
+_echart_simd_interval_float_avx2(const void *values, unsigned int count, double *vmin, double *vmax)
+{
+    const float *v;
+    __m256 mn;
+    __m256 mx;
+    float tmin[8];
+    float tmax[8];
+    unsigned int i;
+    unsigned int k;
+
+    v = (const float *)values;
+    mn = mx = _mm256_set1_ps(v[0]);
+    for (i = 1; i + 8 <= count; i += 8)
+    {
+        __m256 x;
+
+        x = _mm256_loadu_ps(v + i);
+        mn = _mm256_min_ps(x, mn);
+        mx = _mm256_max_ps(x, mx);
+    }
+    _mm256_storeu_ps(tmin, mn);
+    _mm256_storeu_ps(tmax, mx);
+
+    for (k = 1; k < 8; k++)
+    {
+        if (tmin[k] < tmin[0]) tmin[0] = tmin[k];
+        if (tmax[k] > tmax[0]) tmax[0] = tmax[k];
+    }
+    for (; i < count; i++)
+    {
+        if (v[i] < tmin[0]) tmin[0] = v[i];
+        if (v[i] > tmax[0]) tmax[0] = v[i];
+    }
+
+    *vmin = (double)tmin[0];
+    *vmax = (double)tmax[0];
+}
+
+__attribute__((target("avx2")))
+static void
+_echart_simd_interval_int32_avx2(const void *values, unsigned int count, double *vmin, double *vmax)
+{
+    const int32_t *v;
+    __m256i mn;
+    __m256i mx;
+    int32_t tmin[8];
+    int32_t tmax[8];
+    unsigned int i;
+    unsigned int k;
+
+    v = (const int32_t *)values;
+    mn = mx = _mm256_set1_epi32(v[0]);
+    for (i = 1; i + 8 <= count; i += 8)
+    {
+        __m256i x;
+
+        x = _mm256_loadu_si256((const __m256i *)(v + i));
+        mn = _mm256_min_epi32(x, mn);
+        mx = _mm256_max_epi32(x, mx);
+    }
+    _mm256_storeu_si256((__m256i *)tmin, mn);
+    _mm256_storeu_si256((__m256i *)tmax, mx);
+
+    for (k = 1; k < 8; k++)
+    {
+        if (tmin[k] < tmin[0]) tmin[0] = tmin[k];
+        if (tmax[k] > tmax[0]) tmax[0] = tmax[k];
+    }
+    for (; i < count; i++)
+    {
+        if (v[i] < tmin[0]) tmin[0] = v[i];
+        if (v[i] > tmax[0]) tmax[0] = v[i];
+    }
+
+    *vmin = (double)tmin[0];
+    *vmax = (double)tmax[0];
+}
+
+__attribute__((target("avx2")))
+static void
+_echart_simd_dilate_avx2(const double *lo, const double *hi, unsigned int count, double *lo_res, double *hi_res)
+{
+    unsigned int i;
+
+    for (i = 1; i + 5 <= count; i += 4)
+    {
+        __m256d l;
+        __m256d h;
+
+        l = _mm256_min_pd(_mm256_min_pd(_mm256_loadu_pd(lo + i - 1), _mm256_loadu_pd(lo + i)), _mm256_loadu_pd(lo + i + 1));
+        h = _mm256_max_pd(_mm256_max_pd(_mm256_loadu_pd(hi + i - 1), _mm256_loadu_pd(hi + i)), _mm256_loadu_pd(hi + i + 1));
+        _mm256_storeu_pd(lo_res + i, l);
+        _mm256_storeu_pd(hi_res + i, h);
+    }
+
+    _echart_simd_dilate_c(lo + i - 1, hi + i - 1, count - i + 1, lo_res + i - 1, hi_res + i - 1);
+}
+
+#endif
+
+static Echart_Simd_Interval _echart_simd_interval = _echart_simd_interval_c;
+static Echart_Simd_Sum _echart_simd_sum = _echart_simd_sum_c;
+static Echart_Simd_Transform _echart_simd_transform = _echart_simd_transform_c;
+static Echart_Simd_Interval_Typed _echart_simd_interval_float = _echart_simd_interval_float_c;
+static Echart_Simd_Interval_Typed _echart_simd_interval_int32 = _echart_simd_interval_int32_c;
+static Echart_Simd_Transform_Typed _echart_simd_transform_float = _echart_simd_transform_float_c;
+static Echart_Simd_Transform_Typed _echart_simd_transform_int32 = _echart_simd_transform_int32_c;
+static Echart_Simd_Dilate _echart_simd_dilate = _echart_simd_dilate_c;
+
+/**
+ * @endcond
+ */
+
+/*============================================================================*
+ *                                 Global                                     *
+ *============================================================================*/
+
+void
+echart_simd_init(void)
+{
+#ifdef ECHART_SIMD_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+    {
+        DBG("Using AVX2 kernels");
+        _echart_simd_interval = _echart_simd_interval_avx2;
+        _echart_simd_sum = _echart_simd_sum_avx2;
+        _echart_simd_transform = _echart_simd_transform_avx2;
+        _echart_simd_interval_float = _echart_simd_interval_float_avx2;
+        _echart_simd_interval_int32 = _echart_simd_interval_int32_avx2;
+        _echart_simd_transform_float = _echart_simd_transform_float_avx2;
+        _echart_simd_transform_int32 = _echart_simd_transform_int32_avx2;
+        _echart_simd_dilate = _echart_simd_dilate_avx2;
+    }
+    else if (__builtin_cpu_supports("sse2"))
+    {
+        DBG("Using SSE2 kernels");
+        _echart_simd_interval = _echart_simd_interval_sse2;
+        _echart_simd_sum = _echart_simd_sum_sse2;
+        _echart_simd_transform = _echart_simd_transform_sse2;
+        _echart_simd_interval_float = _echart_simd_interval_float_sse2;
+        _echart_simd_interval_int32 = _echart_simd_interval_int32_sse2;
+        _echart_simd_transform_float = _echart_simd_transform_float_sse2;
+        _echart_simd_transform_int32 = _echart_simd_transform_int32_sse2;
+        _echart_simd_dilate = _echart_simd_dilate_sse2;
+    }
+#endif
+}
+
+/* count must be greater than 0 */
+void
+echart_simd_interval_get(const double *values, unsigned int count, double *vmin, double *vmax)
+{
+    _echart_simd_interval(values, count, vmin, vmax);
+}
+
+double
+echart_simd_sum(const double *values, unsigned int count)
+{
+    return _echart_simd_sum(values, count);
+}
+
+/* res[i] = offset + scale * values[i], res can be values */
+void
+echart_simd_transform(const double *values, unsigned int count, double offset, double scale, double *res)
+{
+    _echart_simd_transform(values, count, offset, scale, res);
+}
+
+/* count contiguous values of the given type, count must be greater than 0 */
+void
+echart_simd_interval_typed_get(const void *values, Echart_Value_Type type, unsigned int count, double *vmin, double *vmax)
+{
+    switch (type)
+    {
+        case ECHART_VALUE_TYPE_DOUBLE:
+            _echart_simd_interval((const double *)values, count, vmin, vmax);
+            break;
+        case ECHART_VALUE_TYPE_FLOAT:
+            _echart_simd_interval_float(values, count, vmin, vmax);
+            break;
+        case ECHART_VALUE_TYPE_INT32:
+            _echart_simd_interval_int32(values, count, vmin, vmax);
+            break;
+        case ECHART_VALUE_TYPE_INT64:
+            _echart_simd_interval_int64_c(values, count, vmin, vmax);
+            break;
+        default:
+            *vmin = 0.0;
+            *vmax = 0.0;
+            break;
+    }
+}
+
+void
+echart_simd_transform_typed(const void *values, Echart_Value_Type type, unsigned int count, double offset, double scale, double *res)
+{
+    switch (type)
+    {
+        case ECHART_VALUE_TYPE_DOUBLE:
+            _echart_simd_transform((const double *)values, count, offset, scale, res);
+            break;
+        case ECHART_VALUE_TYPE_FLOAT:
+            _echart_simd_transform_float(values, count, offset, scale, res);
+            break;
+        case ECHART_VALUE_TYPE_INT32:
+            _echart_simd_transform_int32(values, count, offset, scale, res);
+            break;
+        case ECHART_VALUE_TYPE_INT64:
+            _echart_simd_transform_int64_c(values, count, offset, scale, res);
+            break;
+        default:
+            break;
+    }
+}
+
+/*
+ * lo_res[i] and hi_res[i] are the min of lo and the max of hi over
+ * [i - 1, i + 1], the results being other arrays
+ */
+void
+echart_simd_dilate(const double *lo, const double *hi, unsigned int count, double *lo_res, double *hi_res)
+{
+    if (count < 2)
+    {
+        if (count)
+        {
+            lo_res[0] = lo[0];
+            hi_res[0] = hi[0];
+        }
+        return;
+    }
+
+    _echart_simd_dilate_bounds(lo, hi, count, lo_res, hi_res);
+    _echart_simd_dilate(lo, hi, count, lo_res, hi_res);
+}